@@ -0,0 +1,560 @@
+/*******************************************************************************
+ *
+ *  Filename:  CDPatch.c
+ *
+ *  Description:  This program writes a rebuilt BIN archive back into a raw
+ *  CD image (2352-byte sectors). Only the sectors whose data changed are
+ *  rewritten, with their EDC and ECC computed again, so the image stays
+ *  bootable without rebuilding it.
+ *
+ *  Author:  happy_land
+ *  Date:  2026-10-18
+ *  Last update:  --
+ *
+ *******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "compat.c"
+#include "stats.c"
+
+#define RAW_SECTOR_SIZE     2352
+#define DATA_SECTOR_SIZE    2048
+#define MODE1_DATA_OFFSET   0x10    // (12) + (4)
+#define MODE2_DATA_OFFSET   0x18    // (12) + (4) + (8)
+#define PVD_SECTOR          16
+#define ISO_DIRECTORY       0x02
+
+static const uint8_t SYNC_PATTERN[12] = { 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00 };
+
+/*==============================================================*/
+/*	EDC / ECC													*/
+/*==============================================================*/
+// EDC: ׽ 0xD8018001 CRC (ݻ, ʱⰪ 0), 8Ʈ óϴ ̺ 8
+// ECC: GF(2^8) (x^8 + x^4 + x^3 + x^2 + 1)  P/Q иƼ
+static uint32_t edc_table[8][256];
+static uint8_t ecc_f_table[256];
+static uint8_t ecc_b_table[256];
+
+void init_tables(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t j = (i << 1) ^ (i & 0x80 ? 0x11d : 0);
+        ecc_f_table[i] = (uint8_t)j;
+        ecc_b_table[i ^ j] = (uint8_t)i;
+
+        uint32_t edc = i;
+        for (int k = 0; k < 8; k++) {
+            edc = (edc >> 1) ^ (edc & 1 ? 0xd8018001 : 0);
+        }
+        edc_table[0][i] = edc;
+    }
+    for (int t = 1; t < 8; t++) {
+        for (int i = 0; i < 256; i++) {
+            uint32_t edc = edc_table[t - 1][i];
+            edc_table[t][i] = (edc >> 8) ^ edc_table[0][edc & 0xff];
+        }
+    }
+}
+
+uint32_t compute_edc(const uint8_t *data, size_t size) {
+    uint32_t edc = 0;
+    while (size >= 8) {
+        uint32_t one = (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24)) ^ edc;
+        uint32_t two = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24);
+        edc = edc_table[7][one & 0xff] ^ edc_table[6][(one >> 8) & 0xff] ^
+              edc_table[5][(one >> 16) & 0xff] ^ edc_table[4][one >> 24] ^
+              edc_table[3][two & 0xff] ^ edc_table[2][(two >> 8) & 0xff] ^
+              edc_table[1][(two >> 16) & 0xff] ^ edc_table[0][two >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size--) {
+        edc = (edc >> 8) ^ edc_table[0][(edc ^ *data++) & 0xff];
+    }
+    return edc;
+}
+
+// major_count  minor_countƮ о иƼ 2Ʈ 
+void compute_ecc_block(const uint8_t *src, int major_count, int minor_count, int major_mult, int minor_inc, uint8_t *dest) {
+    int size = major_count * minor_count;
+    for (int major = 0; major < major_count; major++) {
+        int index = (major >> 1) * major_mult + (major & 1);
+        uint8_t ecc_a = 0, ecc_b = 0;
+        for (int minor = 0; minor < minor_count; minor++) {
+            uint8_t value = src[index];
+            index += minor_inc;
+            if (index >= size) {
+                index -= size;
+            }
+            ecc_a ^= value;
+            ecc_b ^= value;
+            ecc_a = ecc_f_table[ecc_a];
+        }
+        ecc_a = ecc_b_table[ecc_f_table[ecc_a] ^ ecc_b];
+        dest[major] = ecc_a;
+        dest[major + major_count] = ecc_a ^ ecc_b;
+    }
+}
+
+void write_u32(uint8_t *data, uint32_t value) {
+    data[0] = value & 0xff;
+    data[1] = (value >> 8) & 0xff;
+    data[2] = (value >> 16) & 0xff;
+    data[3] = value >> 24;
+}
+
+//   ( Ʈ)  EDC ECC ٽ 
+void update_sector(uint8_t *sector) {
+    if (sector[0x0f] == 1) {
+        write_u32(sector + 0x810, compute_edc(sector, 0x810));
+        memset(sector + 0x814, 0, 8);
+        compute_ecc_block(sector + 0x0c, 86, 24, 2, 86, sector + 0x81c);    // P
+        compute_ecc_block(sector + 0x0c, 52, 43, 86, 88, sector + 0x8c8);   // Q
+    } else if (sector[0x12] & 0x20) {
+        // Mode 2 Form 2: ECC 
+        write_u32(sector + 0x92c, compute_edc(sector + 0x10, 0x91c));
+    } else {
+        // Mode 2 Form 1: ECC  ( ּ) 0  
+        uint8_t address[4];
+        write_u32(sector + 0x818, compute_edc(sector + 0x10, 0x808));
+        memcpy(address, sector + 0x0c, 4);
+        memset(sector + 0x0c, 0, 4);
+        compute_ecc_block(sector + 0x0c, 86, 24, 2, 86, sector + 0x81c);
+        compute_ecc_block(sector + 0x0c, 52, 43, 86, 88, sector + 0x8c8);
+        memcpy(sector + 0x0c, address, 4);
+    }
+}
+
+/*==============================================================*/
+/*	̹ б													*/
+/*==============================================================*/
+typedef struct {
+    FILE *file;
+    size_t sector_size;             // RAW_SECTOR_SIZE Ǵ DATA_SECTOR_SIZE (ISO)
+    uint32_t sector_count;
+} CdImage;
+
+// ͸ ȿ ã  (ũ⸦ ٲ  ĥ ڵ ġ )
+typedef struct {
+    uint32_t lba;
+    uint32_t size;
+    uint32_t record_lba;
+    uint32_t record_offset;
+} CdEntry;
+
+int read_raw_sectors(CdImage *image, uint32_t lba, uint32_t count, uint8_t *buffer) {
+    if ((uint64_t)lba + count > image->sector_count) {
+        fprintf(stderr, "Sectors %u-%u are outside the image\n", lba, lba + count - 1);
+        return 1;
+    }
+    fseek(image->file, (long)(lba * image->sector_size), SEEK_SET);
+    if (fread(buffer, image->sector_size, count, image->file) != count) {
+        fprintf(stderr, "Unexpected end of the image\n");
+        return 1;
+    }
+    stats.bytes_read += (uint64_t)count * image->sector_size;
+    return 0;
+}
+
+uint8_t *sector_data(CdImage *image, uint8_t *sector) {
+    if (image->sector_size == DATA_SECTOR_SIZE) {
+        return sector;
+    }
+    return sector + (sector[0x0f] == 1 ? MODE1_DATA_OFFSET : MODE2_DATA_OFFSET);
+}
+
+//   (2048Ʈ) ̾ ٿ 
+uint8_t *read_data_sectors(CdImage *image, uint32_t lba, uint32_t count) {
+    uint8_t *raw = (uint8_t *)malloc((size_t)count * image->sector_size);
+    uint8_t *data = (uint8_t *)malloc((size_t)count * DATA_SECTOR_SIZE);
+    if (!raw || !data) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        exit(1);
+    }
+    if (read_raw_sectors(image, lba, count, raw) != 0) {
+        free(raw);
+        free(data);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        memcpy(data + (size_t)i * DATA_SECTOR_SIZE, sector_data(image, raw + (size_t)i * image->sector_size), DATA_SECTOR_SIZE);
+    }
+    free(raw);
+    return data;
+}
+
+// CUE Ʈ FILE  BIN θ path 
+void resolve_cue(const char *image_file, char *path, size_t path_size) {
+    size_t length = strlen(image_file);
+    snprintf(path, path_size, "%s", image_file);
+    if (length < 4 || (strcmp(image_file + length - 4, ".cue") != 0 && strcmp(image_file + length - 4, ".CUE") != 0)) {
+        return;
+    }
+
+    FILE *file = NULL;
+    errno_t err = fopen_s(&file, image_file, "r");
+    if (err != 0 || file == NULL) {
+        return;
+    }
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+        char *p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (strncmp(p, "FILE", 4) != 0) {
+            continue;
+        }
+        // FILE "̸  .bin" BINARY Ǵ FILE name.bin BINARY (cdimage.py )
+        p += 4;
+        while (isspace((unsigned char)*p)) p++;
+        char *name = p;
+        char *end;
+        if (*p == '"') {
+            name = p + 1;
+            end = strchr(name, '"');
+        } else {
+            //  ܾ (BINARY )  
+            end = p + strlen(p);
+            while (end > p && isspace((unsigned char)end[-1])) end--;
+            while (end > p && !isspace((unsigned char)end[-1])) end--;
+            while (end > p && isspace((unsigned char)end[-1])) end--;
+        }
+        if (!end || end == name) {
+            continue;
+        }
+        *end = '\0';
+
+        // CUE   
+        const char *slash = strrchr(image_file, '/');
+        const char *backslash = strrchr(image_file, '\\');
+        if (backslash > slash) slash = backslash;
+        int folder_length = slash ? (int)(slash - image_file + 1) : 0;
+        snprintf(path, path_size, "%.*s%s", folder_length, image_file, name);
+        break;
+    }
+    fclose(file);
+}
+
+int open_image(CdImage *image, const char *image_file) {
+    char path[1024];
+    resolve_cue(image_file, path, sizeof(path));
+
+    FILE *file = NULL;
+    errno_t err = fopen_s(&file, path, "r+b");
+    if (err != 0 || file == NULL) {
+        perror("Unable to open the image");
+        return 1;
+    }
+
+    uint8_t head[sizeof(SYNC_PATTERN)] = {0};
+    fread(head, 1, sizeof(head), file);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+
+    image->file = file;
+    image->sector_size = memcmp(head, SYNC_PATTERN, sizeof(SYNC_PATTERN)) == 0 ? RAW_SECTOR_SIZE : DATA_SECTOR_SIZE;
+    image->sector_count = (uint32_t)(size / image->sector_size);
+    return 0;
+}
+
+//   κ ͸ ڵ ̸  (ҹ,  ';1' )
+int match_name(const uint8_t *name, int name_length, const char *part, size_t part_length) {
+    int length = 0;
+    while (length < name_length && name[length] != ';') {
+        length++;
+    }
+    if ((size_t)length != part_length) {
+        return 0;
+    }
+    for (int i = 0; i < length; i++) {
+        if (toupper(name[i]) != toupper((unsigned char)part[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// ISO9660 ͸ 󰡸 path (: DATA/ST00.BIN) ã
+int find_entry(CdImage *image, const char *path, CdEntry *entry) {
+    uint8_t *pvd = read_data_sectors(image, PVD_SECTOR, 1);
+    if (!pvd) {
+        return 1;
+    }
+    if (pvd[0] != 1 || memcmp(pvd + 1, "CD001", 5) != 0) {
+        fprintf(stderr, "Not an ISO9660 image\n");
+        free(pvd);
+        return 1;
+    }
+    uint32_t lba = pvd[0x9c + 2] | (pvd[0x9c + 3] << 8) | (pvd[0x9c + 4] << 16) | ((uint32_t)pvd[0x9c + 5] << 24);
+    uint32_t size = pvd[0x9c + 10] | (pvd[0x9c + 11] << 8) | (pvd[0x9c + 12] << 16) | ((uint32_t)pvd[0x9c + 13] << 24);
+    free(pvd);
+
+    const char *part = path;
+    while (*part == '/' || *part == '\\') part++;
+    while (*part) {
+        size_t part_length = strcspn(part, "/\\");
+        uint32_t count = (size + DATA_SECTOR_SIZE - 1) / DATA_SECTOR_SIZE;
+        uint8_t *data = read_data_sectors(image, lba, count);
+        if (!data) {
+            return 1;
+        }
+
+        int found = 0;
+        uint32_t offset = 0;
+        while (offset < size && !found) {
+            uint8_t length = data[offset];
+            if (length == 0) {
+                // ڵ  踦  Ƿ  ͷ
+                offset = (offset / DATA_SECTOR_SIZE + 1) * DATA_SECTOR_SIZE;
+                continue;
+            }
+            const uint8_t *record = data + offset;
+            if (match_name(record + 0x21, record[0x20], part, part_length)) {
+                entry->lba = record[2] | (record[3] << 8) | (record[4] << 16) | ((uint32_t)record[5] << 24);
+                entry->size = record[10] | (record[11] << 8) | (record[12] << 16) | ((uint32_t)record[13] << 24);
+                entry->record_lba = lba + offset / DATA_SECTOR_SIZE;
+                entry->record_offset = offset % DATA_SECTOR_SIZE;
+                found = (record[0x19] & ISO_DIRECTORY) ? 2 : 1;
+            }
+            offset += length;
+        }
+        free(data);
+
+        part += part_length;
+        while (*part == '/' || *part == '\\') part++;
+        if (!found || (found == 1) != (*part == '\0')) {
+            fprintf(stderr, "%s is not in the image\n", path);
+            return 1;
+        }
+        lba = entry->lba;
+        size = entry->size;
+    }
+    return 0;
+}
+
+/*==============================================================*/
+/*	ġ														*/
+/*==============================================================*/
+typedef struct {
+    uint8_t *sectors;               // ٲ  ( )
+    size_t start, end;
+} Worker;
+
+void *update_worker(void *arg) {
+    Worker *worker = (Worker *)arg;
+    for (size_t i = worker->start; i < worker->end; i++) {
+        update_sector(worker->sectors + i * RAW_SECTOR_SIZE);
+    }
+    return NULL;
+}
+
+int get_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+// ٲ  EDC/ECC  thread_count  
+void update_sectors(uint8_t *sectors, size_t count, int thread_count) {
+    if ((size_t)thread_count > count) {
+        thread_count = (int)count;
+    }
+    if (thread_count <= 1) {
+        Worker worker = { sectors, 0, count };
+        update_worker(&worker);
+        return;
+    }
+
+    pthread_t *threads = (pthread_t *)malloc(thread_count * sizeof(pthread_t));
+    Worker *workers = (Worker *)calloc(thread_count, sizeof(Worker));
+    for (int i = 0; i < thread_count; i++) {
+        workers[i].sectors = sectors;
+        workers[i].start = count * i / thread_count;
+        workers[i].end = count * (i + 1) / thread_count;
+        pthread_create(&threads[i], NULL, update_worker, &workers[i]);
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(workers);
+    free(threads);
+}
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+} ByteArray;
+
+ByteArray read_file(const char *filename) {
+    ByteArray array = {NULL, 0};
+    FILE *file = NULL;
+    errno_t err = fopen_s(&file, filename, "rb");
+    if (err != 0 || file == NULL) {
+        fprintf(stderr, "Failed to open %s\n", filename);
+        return array;
+    }
+    fseek(file, 0, SEEK_END);
+    array.size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    array.data = (uint8_t *)malloc(array.size ? array.size : 1);
+    if (!array.data || fread(array.data, 1, array.size, file) != array.size) {
+        fprintf(stderr, "Failed to read %s\n", filename);
+        free(array.data);
+        array.data = NULL;
+    }
+    fclose(file);
+    return array;
+}
+
+int patch_image(CdImage *image, const char *path, const ByteArray *archive, int thread_count) {
+    CdEntry entry;
+    if (find_entry(image, path, &entry) != 0) {
+        return 1;
+    }
+
+    //  ű  Ƿ  ϴ  ȿ  
+    uint32_t old_count = (entry.size + DATA_SECTOR_SIZE - 1) / DATA_SECTOR_SIZE;
+    uint32_t new_count = (uint32_t)((archive->size + DATA_SECTOR_SIZE - 1) / DATA_SECTOR_SIZE);
+    if (new_count > old_count) {
+        fprintf(stderr, "%s does not fit: %u sectors > %u sectors\n", path, new_count, old_count);
+        return 1;
+    }
+
+    stats_begin(PHASE_READ);
+    uint8_t *raw = (uint8_t *)malloc(((size_t)new_count + 1) * image->sector_size);
+    uint32_t *changed_lba = (uint32_t *)malloc(((size_t)new_count + 1) * sizeof(uint32_t));
+    uint8_t *changed = (uint8_t *)malloc(((size_t)new_count + 1) * RAW_SECTOR_SIZE);
+    if (!raw || !changed_lba || !changed) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        exit(1);
+    }
+    int result = new_count ? read_raw_sectors(image, entry.lba, new_count, raw) : 0;
+    stats_end(PHASE_READ);
+
+    //  Ͱ ޶ ͸  (   κ 0)
+    stats_begin(PHASE_PROCESS);
+    size_t changed_count = 0;
+    uint8_t data[DATA_SECTOR_SIZE];
+    for (uint32_t i = 0; result == 0 && i < new_count; i++) {
+        size_t offset = (size_t)i * DATA_SECTOR_SIZE;
+        size_t length = archive->size - offset < DATA_SECTOR_SIZE ? archive->size - offset : DATA_SECTOR_SIZE;
+        memcpy(data, archive->data + offset, length);
+        memset(data + length, 0, DATA_SECTOR_SIZE - length);
+
+        uint8_t *sector = raw + (size_t)i * image->sector_size;
+        if (memcmp(sector_data(image, sector), data, DATA_SECTOR_SIZE) != 0) {
+            uint8_t *copy = changed + changed_count * RAW_SECTOR_SIZE;
+            memcpy(copy, sector, image->sector_size);
+            memcpy(sector_data(image, copy), data, DATA_SECTOR_SIZE);
+            changed_lba[changed_count++] = entry.lba + i;
+        }
+    }
+
+    // ũⰡ ٲ ͸ ڵ ũ (Ʋ/ ) ħ
+    if (result == 0 && entry.size != archive->size) {
+        uint8_t *copy = changed + changed_count * RAW_SECTOR_SIZE;
+        result = read_raw_sectors(image, entry.record_lba, 1, copy);
+        if (result == 0) {
+            uint8_t *record = sector_data(image, copy) + entry.record_offset;
+            uint32_t size = (uint32_t)archive->size;
+            write_u32(record + 10, size);
+            record[14] = size >> 24;
+            record[15] = (size >> 16) & 0xff;
+            record[16] = (size >> 8) & 0xff;
+            record[17] = size & 0xff;
+            changed_lba[changed_count++] = entry.record_lba;
+        }
+    }
+
+    if (result == 0 && image->sector_size == RAW_SECTOR_SIZE) {
+        update_sectors(changed, changed_count, thread_count);
+    }
+    stats_end(PHASE_PROCESS);
+
+    // ӵ ʹ   
+    stats_begin(PHASE_WRITE);
+    int write_failed = 0;
+    for (size_t i = 0; result == 0 && !write_failed && i < changed_count; ) {
+        size_t run = 1;
+        while (i + run < changed_count && changed_lba[i + run] == changed_lba[i] + run) {
+            run++;
+        }
+        write_failed = fseek(image->file, (long)(changed_lba[i] * image->sector_size), SEEK_SET) != 0;
+        for (size_t j = 0; !write_failed && j < run; j++) {
+            write_failed = fwrite(changed + (i + j) * RAW_SECTOR_SIZE, 1, image->sector_size, image->file) != image->sector_size;
+        }
+        stats.bytes_written += run * image->sector_size;
+        i += run;
+    }
+    write_failed = write_failed || (result == 0 && fflush(image->file) != 0);
+    if (write_failed) {
+        perror("Unable to write the image");
+        result = 1;
+    }
+    stats_end(PHASE_WRITE);
+
+    if (result == 0) {
+        printf("%zu of %u sectors patched: %s\n", changed_count, new_count, path);
+    }
+
+    free(raw);
+    free(changed_lba);
+    free(changed);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    stats_parse_args(&argc, argv, "CDPatch");
+    stats.input = argc > 3 ? argv[3] : "";
+    stats.command = "patch";
+
+    if (argc < 4 || argc > 5) {
+        fprintf(stderr, "Usage: %s <image.bin|image.cue> <path_in_image> <input_archive> [<threads>] [--stats[=json]]\n", argv[0]);
+        return 1;
+    }
+
+    int thread_count = argc > 4 ? atoi(argv[4]) : 0;
+    if (thread_count <= 0) {
+        thread_count = get_cpu_count();
+    }
+
+    ByteArray archive = read_file(argv[3]);
+    if (!archive.data) {
+        return 1;
+    }
+    stats.bytes_read += archive.size;
+
+    CdImage image;
+    if (open_image(&image, argv[1]) != 0) {
+        free(archive.data);
+        return 1;
+    }
+    init_tables();
+
+    int result = patch_image(&image, argv[2], &archive, thread_count);
+
+    fclose(image.file);
+    free(archive.data);
+
+    stats_report();
+    return result;
+}
+
+/*==============================================================*/
+/*	"CDPatch.c"	End of File										*/
+/*==============================================================*/
@@ -6,7 +6,7 @@
  *  
  *  Author:  happy_land
  *  Date:  2024-06-18
- *  Last update:  2024-09-14
+ *  Last update:  2026-10-18
  *  
  *******************************************************************************/
  
@@ -15,6 +15,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "compat.c"
+#include "stats.c"
+
 void bit_combine(uint32_t* out, uint32_t* tp1, uint32_t* tp2, size_t size) {
     for (size_t cnt = 0; cnt < size; cnt++) {
         out[cnt] = (tp1[cnt] & 0x33333333) | ((tp2[cnt] & 0x33333333) << 2);
@@ -62,24 +65,16 @@ size_t read_file(const char* filename, size_t offset, uint32_t** buffer) {
     }
 
     fclose(file);
+    stats.bytes_read += actual_read_size;
     return actual_read_size / sizeof(uint32_t);
 }
 
 void write_file(const char* filename, uint32_t* buffer, size_t size) {
-    FILE* file = NULL;
-    errno_t err = fopen_s(&file, filename, "wb");
-    if (err != 0 || !file) {
-        perror("Error opening file for writing");
-        exit(EXIT_FAILURE);
-    }
-
-    size_t write_size = fwrite(buffer, sizeof(uint32_t), size, file);
-    if (write_size != size) {
+    if (replace_file(filename, "wb", buffer, size * sizeof(uint32_t)) != 0) {
         perror("Error writing file");
         exit(EXIT_FAILURE);
     }
-
-    fclose(file);
+    stats.bytes_written += size * sizeof(uint32_t);
 }
 
 void create_tim_header(uint8_t* header, uint32_t* palette, size_t palette_size) {
@@ -154,6 +149,7 @@ void append_palette(const char* clt_file, const char* tim_file1, const char* tim
 
     fread(buffer1, 1, size1, tim1);
     fread(buffer2, 1, size2, tim2);
+    stats.bytes_read += 0x100 + size1 + size2;
 
     fclose(tim1);
     fclose(tim2);
@@ -166,6 +162,7 @@ void append_palette(const char* clt_file, const char* tim_file1, const char* tim
 
     fwrite(header2, sizeof(uint8_t), 288, tim2);
     fwrite(buffer2, 1, size2, tim2);
+    stats.bytes_written += 288 * 2 + size1 + size2;
 
     fclose(tim1);
     fclose(tim2);
@@ -186,6 +183,7 @@ uint32_t read_offset_value(const char *filename, size_t offset) {
 
     uint32_t value;
     fread(&value, sizeof(uint32_t), 1, file);
+    stats.bytes_read += sizeof(uint32_t);
 
     fclose(file);
     
@@ -193,8 +191,10 @@ uint32_t read_offset_value(const char *filename, size_t offset) {
 }
 
 int main(int argc, char *argv[]) {
+    stats_parse_args(&argc, argv, "FontTool");
+
     if (argc < 3) {
-        fprintf(stderr, "Usage: %s <combine|split> <input folder> [<input file 2> <output file>]\n", argv[0]);
+        fprintf(stderr, "Usage: %s <combine|split> <input folder> [<input file 2> <output file>] [--stats[=json]]\n", argv[0]);
         return EXIT_FAILURE;
     }
 
@@ -207,6 +207,8 @@ int main(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
         
+        stats.phase_names[PHASE_PROCESS] = "combine";
+        stats_begin(PHASE_READ);
         uint32_t value1 = read_offset_value(argv[2], 0x08);
         uint32_t value2 = read_offset_value(argv[3], 0x08);
         
@@ -215,6 +217,7 @@ int main(int argc, char *argv[]) {
         
         size1 = read_file(argv[2], read_size1, &tp1);
         size2 = read_file(argv[3], read_size2, &tp2);
+        stats_end(PHASE_READ);
 
         if (size1 != size2) {
             fprintf(stderr, "Error: Input files must be of the same size\n");
@@ -227,8 +230,13 @@ int main(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        stats_begin(PHASE_PROCESS);
         bit_combine(out, tp1, tp2, size1);
+        stats_end(PHASE_PROCESS);
+
+        stats_begin(PHASE_WRITE);
         write_file(argv[4], out, size1);
+        stats_end(PHASE_WRITE);
 
         free(tp1);
         free(tp2);
@@ -242,7 +250,10 @@ int main(int argc, char *argv[]) {
 
         char input_file[256];
         snprintf(input_file, sizeof(input_file), "%s/0000_INIT.PIX", argv[2]);
+        stats.phase_names[PHASE_PROCESS] = "split";
+        stats_begin(PHASE_READ);
         size1 = read_file(input_file, 0, &out);
+        stats_end(PHASE_READ);
         size2 = size1;
 
         tp1 = (uint32_t*)malloc(size1 * sizeof(uint32_t));
@@ -253,7 +264,9 @@ int main(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        stats_begin(PHASE_PROCESS);
         bit_split(tp1, tp2, out, size1);
+        stats_end(PHASE_PROCESS);
 
         char output_file1[256];
         char output_file2[256];
@@ -261,12 +274,15 @@ int main(int argc, char *argv[]) {
         snprintf(output_file1, sizeof(output_file1), "FONT1.TIM");
         snprintf(output_file2, sizeof(output_file2), "FONT2.TIM");
 
+        // ȷƮ ̴  ٽ а Ƿ  ð 
+        stats_begin(PHASE_WRITE);
         write_file(output_file1, tp1, size1);
         write_file(output_file2, tp2, size2);
 
         char clt_file[256];
         snprintf(clt_file, sizeof(clt_file), "%s/0001_INIT.CLT", argv[2]);
         append_palette(clt_file, output_file1, output_file2);
+        stats_end(PHASE_WRITE);
 
         free(tp1);
         free(tp2);
@@ -277,6 +293,7 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
+    stats_report();
     return EXIT_SUCCESS;
 }
 
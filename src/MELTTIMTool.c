@@ -7,7 +7,7 @@
  *  
  *  Author:  happy_land
  *  Date:  2024-06-17
- *  Last update:  2024-09-14
+ *  Last update:  2026-10-18
  *  
  *******************************************************************************/
 
@@ -19,136 +19,25 @@
 #include <time.h>
 #include <libgen.h>
 #include <ctype.h>
+#include <dirent.h>
 
-#define HEADER_SIZE     0x30
-#define WINDOW_SIZE     0x2000
-#define WORD_INVALID    0xffff
-#define MAX_CODED       ((7 << 1) + 2)
-#define MAX_UNCODED     (2 << 1)
-
-#define DEBUG 0
-
-#if DEBUG
-#define DEBUG_PRINT(...) do{ fprintf( stderr, __VA_ARGS__ ); } while( 0 )
+#ifdef _WIN32
+#include <windows.h>
 #else
-#define DEBUG_PRINT(...) do{ } while ( 0 )
+#include <unistd.h>
 #endif
 
-/*==============================================================*/
-/*	   Լ											*/
-/*==============================================================*/
-//  Ư ¿  ̸ŭ  Ͽ  ȯ
-unsigned int unpack_data(const char *data, int offset, int length) {
-    unsigned int result = 0;
-    for (int i = 0; i < length; i++) {
-        result |= ((unsigned char)data[offset + i]) << (8 * i);
-    }
-    return result;
-}
-
-// ۿ ܾ ŷϰ   ȯ
-unsigned short pack_into_buffer(char *buffer, unsigned int destination, unsigned short word) {
-    buffer[destination] = word & 0xff;
-    buffer[destination + 1] = (word >> 8) & 0xff;
-    return destination + 2;
-}
-
-// MELT_TIM ü
-typedef struct {
-    uint32_t timEnum;               // offset: 0x00, value: 0x03
-    uint32_t decompressedSize;     // offset: 0x04
-    uint32_t paddedDataSizeNum;    // offset: 0x08
-    uint16_t paletteFramebufferX;  // offset: 0x0c
-    uint16_t paletteFramebufferY;  // offset: 0x0e
-    uint16_t paletteColors;        // offset: 0x10
-    uint16_t numberOfPalettes;     // offset: 0x12
-    uint16_t imageFramebufferX;    // offset: 0x14
-    uint16_t imageFramebufferY;    // offset: 0x16
-    uint16_t imageWidthBytes;      // offset: 0x18
-    uint16_t imageHeight;          // offset: 0x1a
-    uint16_t dummy[4];
-    uint16_t bitfieldSize;         // offset: 0x24
-    uint16_t dummy_[5];
-} MELT_TIMHeader;
-
-//    Լ
-unsigned int decompress_data(const char *compressed_data, const char *header_data, char **decompressed_data) {
-    MELT_TIMHeader header;
-    
-    //  б
-    header.timEnum = unpack_data(header_data, 0x00, 0x04);
-    if (header.timEnum != 0x03) {
-        printf("It is not a compressed TIM.\n");
-        exit(1);
-    }
-    
-    header.decompressedSize = unpack_data(header_data, 0x04, 0x04);
-    header.bitfieldSize = unpack_data(header_data, 0x24, 0x02);
-
-    unsigned int decompress_size = header.decompressedSize;
-    unsigned short bitfield_length = header.bitfieldSize;
-
-    if (bitfield_length == 0) {
-        fprintf(stderr, "Invalid bitfield length\n");
-        return 0;
-    }
-
-    char *bitfield = (char *)malloc(bitfield_length * 8);
-    if (!bitfield) {
-        perror("Failed to allocate memory for bitfield");
-        return 0;
-    }
-
-    // Ʈʵ б ( )
-    // 0 = ͷ
-    // 1 = 
-    for (int i = 0; i < bitfield_length; i += 4) {
-        unsigned int current_bit = unpack_data(compressed_data, 0 + i, 4);
-        for (int j = 31; j >= 0; j--) {
-            bitfield[i * 8 + (31 - j)] = (current_bit >> j) & 1;
-        }
-    }
+// ϰ   (D)  忡 ϹǷ ڵ ī͸ 
+int codec_counters = 1;
+#define MELT_STATS(...) do{ if (codec_counters) { __VA_ARGS__; } } while ( 0 )
 
-    char *buffer = (char *)malloc(decompress_size);
-    if (!buffer) {
-        perror("Failed to allocate memory for buffer");
-        free(bitfield);
-        return 0;
-    }
-
-    unsigned int destination = 0, window = 0, payload_offset = bitfield_length;
-    for (int i = 0; i < bitfield_length * 8; i++) {
-        if (destination >= decompress_size) {
-            break;
-        }
-        unsigned short word = unpack_data(compressed_data, payload_offset, 0x02);
-        if (!bitfield[i]) {
-            destination = pack_into_buffer(buffer, destination, word);
-            DEBUG_PRINT("Literal word: 0x%04x\n", word);
-        } else if (word == WORD_INVALID) {
-            window += WINDOW_SIZE;
-            DEBUG_PRINT("Window incremented: 0x%04x\n", window);
-        } else {
-            unsigned int source_offset = window + ((word >> 3) & 0x1fff);
-            unsigned short length = (word & 0x07) + 2;
-            DEBUG_PRINT("Copying from offset: 0x%04x, length: 0x%04x\n", source_offset, length);
-            while (length > 0) {
-                if (destination >= decompress_size) {
-                    break;
-                }
-                unsigned short packed_word = unpack_data(buffer, source_offset, 0x02);
-                destination = pack_into_buffer(buffer, destination, packed_word);
-                source_offset += 2;
-                length--;
-            }
-        }
-        payload_offset += 2;
-    }
+#include "compat.c"
+#include "stats.c"
+#include "melt.c"
+#include "headertbl.c"
+#include "batchio.c"
 
-    free(bitfield);
-    *decompressed_data = buffer;
-    return decompress_size;
-}
+#define HEADER_SIZE     0x30
 
 /*==============================================================*/
 /*	  Լ												*/
@@ -201,129 +90,183 @@ ByteArray read_file(const char *filename, size_t offset, size_t limit) {
     //  б
     fread(data, 1, read_size, file);
     fclose(file);
+    stats.bytes_read += read_size;
 
     // ByteArray ü ȯ
     ByteArray byteArray = {data, read_size};
     return byteArray;
 }
 
-// Ʈ Ʈ ϴ ü
-typedef struct {
-    uint8_t *data;
-    size_t size;
-    size_t capacity;
-    uint32_t buffer;
-    int buffer_count;
-} BitStream;
-
-// BitStream ʱȭ Լ
-void init_bitstream(BitStream *bs) {
-    bs->data = (uint8_t *)malloc(1);
-    bs->size = 0;
-    bs->capacity = 1;
-    bs->buffer = 0;
-    bs->buffer_count = 0;
+//   (HEADER.BIN ׸ ).  ׸ ƴϸ ó DASH2  
+const MeltVariant *compress_variant(const ByteArray *org_header) {
+    const MeltVariant *variant = melt_find_variant(org_header->data);
+    return variant ? variant : &melt_variant_dash2;
 }
 
-// Ʈ ߰ϴ Լ
-void add_bits(BitStream *bs, uint32_t bits, int count) {
-    bs->buffer = (bs->buffer << count) | (bits & ((1 << count) - 1));
-    bs->buffer_count += count;
+// Ʈʵ ̷ε带 ̾ ̰  ũ⸦ ä  ͸ 
+uint8_t *finish_data(BitStream *bits, BitStream *payload, ByteArray *org_header, size_t src_size, size_t *final_size) {
+    finalize_bits(bits);
+    add_payload(bits, payload->data, payload->size);
 
-    while (bs->buffer_count >= 32) {
-        bs->buffer_count -= 32;
-        if (bs->size + 4 > bs->capacity) {
-            bs->capacity *= 2;
-            bs->data = (uint8_t *)realloc(bs->data, bs->capacity);
-        }
-        uint32_t out_bits = bs->buffer >> bs->buffer_count;
-        bs->data[bs->size++] = (out_bits >> 0) & 0xFF;
-        bs->data[bs->size++] = (out_bits >> 8) & 0xFF;
-        bs->data[bs->size++] = (out_bits >> 16) & 0xFF;
-        bs->data[bs->size++] = (out_bits >> 24) & 0xFF;
-        bs->buffer &= (1 << bs->buffer_count) - 1;
-    }
-}
+    size_t bit_len = bits->size - payload->size;
+    *((uint32_t *)(org_header->data + 0x04)) = (uint32_t)src_size;  // org_header 0x04  ũ ۼ
+    *((uint16_t *)(org_header->data + 0x24)) = (uint16_t)bit_len;  // org_header 0x24 Ʈʵ  ۼ
 
-// Ʈ  ϴ Լ
-void finalize_bits(BitStream *bs) {
-    if (bs->buffer_count > 0) {
-        bs->buffer <<= (32 - bs->buffer_count);
-        if (bs->size + 4 > bs->capacity) {
-            bs->capacity *= 2;
-            bs->data = (uint8_t *)realloc(bs->data, bs->capacity);
-        }
-        bs->data[bs->size++] = (bs->buffer >> 0) & 0xFF;
-        bs->data[bs->size++] = (bs->buffer >> 8) & 0xFF;
-        bs->data[bs->size++] = (bs->buffer >> 16) & 0xFF;
-        bs->data[bs->size++] = (bs->buffer >> 24) & 0xFF;
-        bs->buffer = 0;
-        bs->buffer_count = 0;
-    }
+    *final_size = org_header->size + bits->size;
+    uint8_t *final_data = (uint8_t *)malloc(*final_size);
+    memcpy(final_data, org_header->data, org_header->size);
+    memcpy(final_data + org_header->size, bits->data, bits->size);
+    return final_data;
 }
 
-// BitStream ͸ ߰ϴ Լ
-void add_payload(BitStream *bs, const uint8_t *data, size_t size) {
-    if (bs->size + size > bs->capacity) {
-        while (bs->size + size > bs->capacity) {
-            bs->capacity *= 2;
-        }
-        bs->data = (uint8_t *)realloc(bs->data, bs->capacity);
+// ͸ ϴ Լ
+uint8_t *compress_data(const char *input_file, const char *header_file, unsigned int header_offset, size_t *final_size) {
+    stats_begin(PHASE_READ);
+    ByteArray src = read_file(input_file, 0, 0);
+    ByteArray org_header = read_file(header_file, header_offset, HEADER_SIZE);
+    stats_end(PHASE_READ);
+
+    stats_begin(PHASE_PROCESS);
+
+    BitStream bits;
+    init_bitstream(&bits);
+
+    BitStream payload;
+    init_bitstream(&payload);
+
+    const MeltVariant *variant = compress_variant(&org_header);
+    size_t pos = 0;
+    for (size_t window_end = variant->window_size; pos < src.size; window_end += variant->window_size) {
+        pos = variant->compress_window(src.data, src.size, pos, window_end, &bits, &payload);
     }
-    memcpy(bs->data + bs->size, data, size);
-    bs->size += size;
+
+    uint8_t *final_data = finish_data(&bits, &payload, &org_header, src.size, final_size);
+
+    free(src.data);
+    free(org_header.data);
+    free(bits.data);
+    free(payload.data);
+    stats_end(PHASE_PROCESS);
+
+    return final_data;
 }
 
-// ̵ 츦 Ͽ   ġ ã Լ
-void find_match(uint8_t *data, size_t pos, size_t len, size_t *match_pos, size_t *match_len) {
-    size_t search_pos = pos / WINDOW_SIZE * WINDOW_SIZE;
-    if (pos >= len) {
-        *match_pos = 0;
-        *match_len = 0;
-        return;
-    }
+/*==============================================================*/
+/*	κ   Լ										*/
+/*==============================================================*/
+//  MTIM  ϳ ϴ  (ū ȣ, ̷ε ġ,   ġ)
+typedef struct {
+    size_t token;
+    size_t payload;
+    size_t pos;
+} WindowMark;
+
+int get_bit(const uint8_t *bitfield, size_t index) {
+    const uint8_t *word = bitfield + index / 32 * 4;
+    uint32_t value = word[0] | (word[1] << 8) | (word[2] << 16) | ((uint32_t)word[3] << 24);
+    return (value >> (31 - index % 32)) & 1;
+}
 
-    size_t length = len - pos;
-    if (length < MAX_UNCODED) {
-        *match_pos = 0;
-        *match_len = 0;
-        return;
+//  MTIM ū 󰡸  踦 ϰ   ȯ
+// marks[count]  ū  
+size_t scan_windows(const MeltVariant *variant, const ByteArray *mtim, size_t size, size_t bitfield_length, WindowMark **marks) {
+    size_t capacity = size / variant->window_size + 2;
+    *marks = (WindowMark *)malloc((capacity + 1) * sizeof(WindowMark));
+    if (!*marks) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        exit(1);
     }
 
-    size_t max_match_length = 0;
-    size_t max_match_position = 0;
-
-    for (size_t i = search_pos; i < pos; ++i) {
-        size_t current_match_length = 0;
-        while (current_match_length < length && i + current_match_length < pos &&
-               data[i + current_match_length] == data[pos + current_match_length]) {
-            current_match_length++;
-            if (current_match_length >= MAX_CODED) {
-                current_match_length = MAX_CODED;
-                break;
+    size_t count = 0, token = 0, payload = bitfield_length, pos = 0;
+    WindowMark first = { 0, payload, 0 };
+    (*marks)[count++] = first;
+
+    while (token < bitfield_length * 8 && payload + 2 <= mtim->size) {
+        int bit = get_bit(mtim->data, token);
+        uint16_t word = mtim->data[payload] | (mtim->data[payload + 1] << 8);
+
+        if (pos >= size) {
+            //  ū ڿ    ǥ
+            if (pos >= count * variant->window_size && bit && word == WORD_INVALID && count < capacity) {
+                WindowMark mark = { token + 1, payload + 2, pos };
+                (*marks)[count++] = mark;
+                token++;
+                payload += 2;
             }
+            break;
         }
 
-        if (current_match_length > max_match_length) {
-            max_match_length = current_match_length;
-            max_match_position = i;
+        if (!bit) {
+            size_t length = pos + 1 == size ? 1 : 2;  // Ȧ ũ  Ʈ
+            pos += length;
+            payload += length;
+        } else if (word == WORD_INVALID) {
+            payload += 2;
+            if (count == capacity) {
+                break;
+            }
+            WindowMark mark = { token + 1, payload, pos };
+            (*marks)[count++] = mark;
+        } else {
+            pos += ((word & ((1u << variant->length_bits) - 1)) + 2) * 2;
+            payload += 2;
         }
+        token++;
     }
 
-    if (max_match_length < MAX_UNCODED) {
-        *match_pos = 0;
-        *match_len = 0;
-        return;
-    }
+    WindowMark end = { token, payload, pos };
+    (*marks)[count] = end;
+    return count;
+}
 
-    *match_pos = max_match_position;
-    *match_len = max_match_length;
+//  k  ū ״   ִ Ȯ
+//   ū  ۺ  + max_coded Ϳ  ġθ 
+int window_unchanged(const MeltVariant *variant, const ByteArray *src, const ByteArray *old, const WindowMark *marks, size_t k, size_t pos) {
+    if (pos != marks[k].pos) {
+        return 0;
+    }
+    size_t base = k * variant->window_size;
+    size_t limit = marks[k + 1].pos + variant->max_coded;
+    if (limit >= src->size || limit >= old->size) {
+        //    ֹǷ ũ⵵ ƾ 
+        if (src->size != old->size) {
+            return 0;
+        }
+        limit = src->size;
+    }
+    return base <= limit && memcmp(src->data + base, old->data + base, limit - base) == 0;
 }
 
-// ͸ ϴ Լ
-uint8_t *compress_data(const char *input_file, const char *header_file, unsigned int header_offset, size_t *final_size) {
+//  MTIM (original_file) ٲ   Ʈ ̷ε ״ ϰ
+// ٲ 츸 ٽ .  MTIM c  ̸  c 
+uint8_t *compress_delta(const char *input_file, const char *original_file, const char *header_file, unsigned int header_offset, size_t *final_size) {
+    stats_begin(PHASE_READ);
     ByteArray src = read_file(input_file, 0, 0);
+    ByteArray mtim = read_file(original_file, 0, 0);
     ByteArray org_header = read_file(header_file, header_offset, HEADER_SIZE);
+    stats_end(PHASE_READ);
+
+    stats_begin(PHASE_PROCESS);
+    Stats counters = stats;  //  MTIM   ڵ īͿ  
+    char *old_data = NULL;
+    unsigned int old_size = decompress_data((const char *)mtim.data, mtim.size, (const char *)org_header.data, &old_data);
+    stats.literals = counters.literals;
+    stats.matches = counters.matches;
+    stats.window_advances = counters.window_advances;
+    memcpy(stats.match_lengths, counters.match_lengths, sizeof(stats.match_lengths));
+    if (old_size == 0) {
+        free(src.data);
+        free(mtim.data);
+        free(org_header.data);
+        stats_end(PHASE_PROCESS);
+        return NULL;
+    }
+    ByteArray old = { (uint8_t *)old_data, old_size };
+
+    WindowMark *marks = NULL;
+    size_t bitfield_length = org_header.data[0x24] | (org_header.data[0x25] << 8);
+    const MeltVariant *variant = compress_variant(&org_header);
+    size_t window_count = scan_windows(variant, &mtim, old.size, bitfield_length, &marks);
 
     BitStream bits;
     init_bitstream(&bits);
@@ -331,58 +274,31 @@ uint8_t *compress_data(const char *input_file, const char *header_file, unsigned
     BitStream payload;
     init_bitstream(&payload);
 
-    size_t pos = 0;
-    size_t next_insert_point = WINDOW_SIZE;
-
-    while (pos < src.size) {
-        size_t match_pos, match_len;
-        find_match(src.data, pos, src.size, &match_pos, &match_len);
-
-        DEBUG_PRINT("Position: 0x%04x, Match offset: 0x%04x, Match length: 0x%04x\n", pos, match_pos, match_len);
-
-        if (match_len >= MAX_UNCODED && match_len % 2 == 0) {
-            add_bits(&bits, 1, 1);
-            uint16_t offset = match_pos & 0x1FFF;
-            uint16_t length = (match_len / 2) - 2;
-            uint16_t word = (offset << 3) | (length & 0x07);
-            add_payload(&payload, (uint8_t *)&word, 2);
-            pos += match_len;
-        } else {
-            add_bits(&bits, 0, 1);
-            if (pos + 1 < src.size) {
-                uint16_t word = src.data[pos] | (src.data[pos + 1] << 8);
-                add_payload(&payload, (uint8_t *)&word, 2);
-                pos += 2;
-            } else {
-                add_payload(&payload, &src.data[pos], 1);
-                pos++;
+    size_t pos = 0, k = 0, reused = 0;
+    for (size_t window_end = variant->window_size; pos < src.size; window_end += variant->window_size, k++) {
+        if (k < window_count && window_unchanged(variant, &src, &old, marks, k, pos)) {
+            for (size_t token = marks[k].token; token < marks[k + 1].token; token++) {
+                add_bits(&bits, get_bit(mtim.data, token), 1);
             }
-        }
-
-        if (pos >= next_insert_point) {
-            add_bits(&bits, 1, 1);
-            uint16_t end_marker = WORD_INVALID;
-            add_payload(&payload, (uint8_t *)&end_marker, 2);
-            next_insert_point += WINDOW_SIZE;
+            add_payload(&payload, mtim.data + marks[k].payload, marks[k + 1].payload - marks[k].payload);
+            pos = marks[k + 1].pos;
+            reused++;
+        } else {
+            pos = variant->compress_window(src.data, src.size, pos, window_end, &bits, &payload);
         }
     }
+    printf("%zu of %zu windows re-encoded\n", k - reused, k);
 
-    finalize_bits(&bits);
-    add_payload(&bits, payload.data, payload.size);
-
-    size_t bit_len = bits.size - payload.size;
-    *((uint32_t *)(org_header.data + 0x04)) = (uint32_t)src.size;  // org_header 0x04  ũ ۼ
-    *((uint16_t *)(org_header.data + 0x24)) = (uint16_t)bit_len;  // org_header 0x24 Ʈʵ  ۼ
-
-    *final_size = org_header.size + bits.size;
-    uint8_t *final_data = (uint8_t *)malloc(*final_size);
-    memcpy(final_data, org_header.data, org_header.size);
-    memcpy(final_data + org_header.size, bits.data, bits.size);
+    uint8_t *final_data = finish_data(&bits, &payload, &org_header, src.size, final_size);
 
     free(src.data);
+    free(mtim.data);
+    free(old.data);
     free(org_header.data);
+    free(marks);
     free(bits.data);
     free(payload.data);
+    stats_end(PHASE_PROCESS);
 
     return final_data;
 }
@@ -416,56 +332,38 @@ const char* get_dirname(const char* path) {
 
 //   Լ
 int write_file(const char *filename, uint8_t *data, size_t size) {
-    FILE *file = NULL;
-    errno_t err = fopen_s(&file, filename, "wb");
-    
-    if (err != 0 || file == NULL) {
-        perror("Unable to open a file");
+    if (replace_file(filename, "wb", data, size) != 0) {
+        perror("Unable to write a file");
         return 1;
     }
-
-    fwrite(data, 1, size, file);
-    fclose(file);
-    return 0;
-}
-
-//  κ  Լ
-int overwrite_file(const char *filename, uint8_t *data, size_t size, unsigned int offset) {
-    FILE *file = NULL;
-    errno_t err = fopen_s(&file, filename, "r+b");
-    
-    if (err != 0 || file == NULL) {
-        perror("Unable to open the file for overwriting");
-        return 1;
-    }
-
-    fseek(file, offset, SEEK_SET);
-    fwrite(data, 1, size, file);
-    fclose(file);
+    stats.bytes_written += size;
     return 0;
 }
 
 int decompress_file(const char *input_file, const char *output_file, const char *header_file, unsigned int header_offset) {
+    stats_begin(PHASE_READ);
+
     //   б
     ByteArray compressed_data = read_file(input_file, 0, 0);
     
     //   б
     ByteArray header_data = read_file(header_file, header_offset, HEADER_SIZE);
+    stats_end(PHASE_READ);
 
     //      ʱȭ
     char *decompressed_data = NULL;
 
     //  
-    unsigned int decompress_size = decompress_data((const char *)compressed_data.data, (const char *)header_data.data, &decompressed_data);
-
-    //   ͸ Ͽ 
-    if (decompress_size > 0) {
-        if (write_file(output_file, (uint8_t *)decompressed_data, decompress_size)) {
-            free(compressed_data.data);
-            free(header_data.data);
-            free(decompressed_data);
-            return 1;
-        }
+    stats_begin(PHASE_PROCESS);
+    unsigned int decompress_size = decompress_data((const char *)compressed_data.data, compressed_data.size, (const char *)header_data.data, &decompressed_data);
+    stats_end(PHASE_PROCESS);
+
+    //   ͸ Ͽ  (  )
+    int result = decompress_size == 0;
+    if (!result) {
+        stats_begin(PHASE_WRITE);
+        result = write_file(output_file, (uint8_t *)decompressed_data, decompress_size);
+        stats_end(PHASE_WRITE);
     }
 
     // ޸ 
@@ -473,30 +371,41 @@ int decompress_file(const char *input_file, const char *output_file, const char
     free(header_data.data);
     free(decompressed_data);
 
-    return 0;
+    return result;
 }
 
-int compress_file(const char *input_file, const char *output_file, const char *header_file, unsigned int header_offset) {
+// delta 1̸ output_file ( MTIM) ٲ  츦 
+int compress_file(const char *input_file, const char *output_file, const char *header_file, unsigned int header_offset, int delta) {
     size_t final_size;
     
-    uint8_t *compressed_data = compress_data(input_file, header_file, header_offset, &final_size);
+    uint8_t *compressed_data = delta ? compress_delta(input_file, output_file, header_file, header_offset, &final_size)
+                                     : compress_data(input_file, header_file, header_offset, &final_size);
 
     if (compressed_data != NULL) {
+        stats_begin(PHASE_WRITE);
+
         //  
         uint8_t header_data[HEADER_SIZE];
         memcpy(header_data, compressed_data, HEADER_SIZE);
 
-        // header_file header_offset ġ header_data 
-        if (overwrite_file(header_file, header_data, HEADER_SIZE, header_offset) != 0) {
+        // header_file header_offset ġ header_data ݿ (ٸ μ ÿ ᵵ )
+        HeaderTable table;
+        header_table_init(&table, header_file);
+        header_table_set(&table, header_offset / HEADER_SIZE, header_data);
+        int result = header_table_commit(&table);
+        header_table_free(&table);
+        if (result != 0) {
             free(compressed_data);
             return 1;
         }
+        stats.bytes_written += HEADER_SIZE;
 
         // compressed_data  ͸ output_file 
         if (write_file(output_file, compressed_data + HEADER_SIZE, final_size - HEADER_SIZE) != 0) {
             free(compressed_data);
             return 1;
         }
+        stats_end(PHASE_WRITE);
 
         free(compressed_data);
         return 0;
@@ -506,14 +415,190 @@ int compress_file(const char *input_file, const char *output_file, const char *h
     }
 }
 
+/*==============================================================*/
+/*	ϰ    Լ									*/
+/*==============================================================*/
+typedef struct {
+    const uint8_t *headers;     // HEADER.BIN
+    size_t header_count;
+    const char *output_folder;
+    size_t decoded;
+    pthread_mutex_t lock;
+} BatchJob;
+
+//  ̸  4ڸ ȣ ( -1)
+int file_index(const char *name) {
+    int index = 0;
+    for (int i = 0; i < 4; i++) {
+        if (!isdigit((unsigned char)name[i])) {
+            return -1;
+        }
+        index = index * 10 + (name[i] - '0');
+    }
+    return name[4] == '_' ? index : -1;
+}
+
+int compare_paths(const void *a, const void *b) {
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+// ۾ 忡 MTIM ϳ   PIX ⸦ ѱ
+void decompress_batch_file(BatchIo *io, const IoFile *file, void *arg) {
+    BatchJob *job = (BatchJob *)arg;
+    const char *name = strrchr(file->path, '/');
+    name = name ? name + 1 : file->path;
+    int index = file_index(name);
+    if (index < 0 || (size_t)index >= job->header_count) {
+        fprintf(stderr, "No header for %s\n", file->path);
+        return;
+    }
+    const uint8_t *header = job->headers + (size_t)index * HEADER_SIZE;
+    size_t size = unpack_data((const char *)header, 0x04, 0x04);
+    unsigned int bitfield_length = unpack_data((const char *)header, 0x24, 0x02);
+    const MeltVariant *variant = melt_find_variant(header);
+    if (!variant || bitfield_length == 0) {
+        fprintf(stderr, "%s is not a compressed TIM.\n", file->path);
+        return;
+    }
+
+    uint8_t *output = (uint8_t *)calloc(size ? size : 1, 1);
+    if (!output) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        exit(1);
+    }
+    if (variant->decompress(file->data, file->size, bitfield_length, output, size) < size) {
+        fprintf(stderr, "%s: compressed data is truncated or corrupt\n", file->path);
+        free(output);
+        return;
+    }
+
+    char base[512];
+    char output_path[1024];
+    strncpy(base, name, sizeof(base) - 1);
+    base[sizeof(base) - 1] = '\0';
+    remove_extension(base);
+    to_uppercase(base);
+    snprintf(output_path, sizeof(output_path), "%s/%s.PIX", job->output_folder, base);
+    batchio_write(io, output_path, output, size);
+
+    pthread_mutex_lock(&job->lock);
+    job->decoded++;
+    pthread_mutex_unlock(&job->lock);
+}
+
+int get_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+//   MTIM    (HEADER.BIN   )
+int decompress_folder(const char *input_folder, const char *output_folder, int thread_count) {
+    char header_path[1024];
+    snprintf(header_path, sizeof(header_path), "%s/HEADER.BIN", input_folder);
+    BatchJob job;
+    memset(&job, 0, sizeof(job));
+    size_t header_size = 0;
+    stats_begin(PHASE_READ);
+    uint8_t *headers = header_table_load(header_path, &header_size);
+    stats_end(PHASE_READ);
+    if (!headers) {
+        fprintf(stderr, "Failed to open %s\n", header_path);
+        return 1;
+    }
+    job.headers = headers;
+    job.header_count = header_size / HEADER_SIZE;
+    job.output_folder = output_folder;
+    pthread_mutex_init(&job.lock, NULL);
+
+    struct stat st;
+    DIR *dir = opendir(input_folder);
+    if (!dir || stat(output_folder, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "Failed to open %s\n", dir ? output_folder : input_folder);
+        if (dir) {
+            closedir(dir);
+        }
+        free(headers);
+        pthread_mutex_destroy(&job.lock);
+        return 1;
+    }
+    size_t count = 0, capacity = 64;
+    char **paths = (char **)malloc(capacity * sizeof(char *));
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        const char *dot = strrchr(ent->d_name, '.');
+        if (file_index(ent->d_name) < 0 || !dot || strcmp(dot, ".MTIM") != 0) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            paths = (char **)realloc(paths, capacity * sizeof(char *));
+        }
+        size_t length = strlen(input_folder) + strlen(ent->d_name) + 2;
+        paths[count] = (char *)malloc(length);
+        snprintf(paths[count], length, "%s/%s", input_folder, ent->d_name);
+        count++;
+    }
+    closedir(dir);
+    qsort(paths, count, sizeof(char *), compare_paths);
+
+    // б,  , Ⱑ ġǷ ó ܰ ϳ 
+    const char *backend = "";
+    uint64_t bytes_read = 0, bytes_written = 0;
+    stats_begin(PHASE_PROCESS);
+    size_t failed = batchio_run((const char **)paths, count, thread_count, decompress_batch_file, &job,
+                                &backend, &bytes_read, &bytes_written);
+    stats_end(PHASE_PROCESS);
+    stats.bytes_read += bytes_read;
+    stats.bytes_written += bytes_written;
+
+    printf("Decompressed %zu of %zu MTIM files to %s (%d threads, %s)\n", job.decoded, count, output_folder, thread_count, backend);
+
+    for (size_t i = 0; i < count; i++) {
+        free(paths[i]);
+    }
+    free(paths);
+    free(headers);
+    pthread_mutex_destroy(&job.lock);
+    return failed || job.decoded != count ? 1 : 0;
+}
+
 int main(int argc, char *argv[]) {
+    stats_parse_args(&argc, argv, "MELTTIMTool");
+    batchio_parse_args(&argc, argv);
+    stats.has_codec = 1;
+
     if (argc < 3 || argc > 5) {
-        fprintf(stderr, "Usage: %s c|d <input_file> [<original_file>] [<output_folder>]\n", argv[0]);
+        fprintf(stderr, "Usage: %s c|p|d <input_file> [<original_file>] [<output_folder>] [--stats[=json]]\n", argv[0]);
+        fprintf(stderr, "       %s D <input_folder> <output_folder> [<threads>] [--io=threads] [--stats[=json]]\n", argv[0]);
         return 1;
     }
 
-    clock_t start_time, end_time;
-    double time_taken;
+    if (strcmp(argv[1], "D") == 0) {
+        if (argc < 4) {
+            fprintf(stderr, "Usage: %s D <input_folder> <output_folder> [<threads>]\n", argv[0]);
+            return 1;
+        }
+        int thread_count = argc == 5 ? atoi(argv[4]) : get_cpu_count();
+        if (thread_count < 1) {
+            thread_count = 1;
+        }
+        codec_counters = 0;
+        stats.has_codec = 0;
+        stats.phase_names[PHASE_PROCESS] = "decode";
+        double batch_start = stats_now();
+        int result = decompress_folder(argv[2], argv[3], thread_count);
+        printf("Decompression took %f seconds\n", stats_now() - batch_start);
+        stats_report();
+        return result;
+    }
+
+    double start_time, time_taken;
 
     // Է  ⺻ ̸ ó 4ڸ 
     char input_file_prefix[5] = {0};
@@ -549,16 +634,17 @@ int main(int argc, char *argv[]) {
         char header_path[1024];
         snprintf(header_path, sizeof(header_path), "%s/HEADER.BIN", get_dirname(argv[2]));
 
-        start_time = clock();
+        stats.phase_names[PHASE_PROCESS] = "decode";
+        start_time = stats_now();
         int result = decompress_file(argv[2], output_path, header_path, header_offset);
-        end_time = clock();
+        time_taken = stats_now() - start_time;
 
-        time_taken = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
         printf("Decompression took %f seconds\n", time_taken);
+        stats_report();
         return result;
-    } else if (strcmp(argv[1], "c") == 0) {
+    } else if (strcmp(argv[1], "c") == 0 || strcmp(argv[1], "p") == 0) {
         if (argc < 4 || argc > 5) {
-            fprintf(stderr, "Usage: %s c <input_file> <original_file>\n", argv[0]);
+            fprintf(stderr, "Usage: %s c|p <input_file> <original_file>\n", argv[0]);
             return 1;
         }
 
@@ -569,15 +655,16 @@ int main(int argc, char *argv[]) {
         char header_path[1024];
         snprintf(header_path, sizeof(header_path), "%s/HEADER.BIN", get_dirname(argv[3]));
 
-        start_time = clock();
-        int result = compress_file(argv[2], output_path, header_path, header_offset);
-        end_time = clock();
+        stats.phase_names[PHASE_PROCESS] = "encode";
+        start_time = stats_now();
+        int result = compress_file(argv[2], output_path, header_path, header_offset, argv[1][0] == 'p');
+        time_taken = stats_now() - start_time;
 
-        time_taken = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
         printf("Compression took %f seconds\n", time_taken);
+        stats_report();
         return result;
     } else {
-        fprintf(stderr, "Invalid command. Use 'c' for compression and 'd' for decompression.\n");
+        fprintf(stderr, "Invalid command. Use 'c' for compression, 'p' to recompress only the changed windows, 'd' for decompression and 'D' to decompress a folder.\n");
         return 1;
     }
 }
@@ -0,0 +1,1625 @@
+/*******************************************************************************
+ *
+ *  Filename:  MSGTool.c
+ *
+ *  Description:  This program converts MSG to TXT and TXT to MSG, and
+ *  builds a script database from every MSG of the game.
+ *
+ *  Author:  happy_land
+ *  Date:  2026-10-18
+ *  Last update:  --
+ *
+ *******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#define make_dir(path) _mkdir(path)
+#else
+#include <unistd.h>
+#define make_dir(path) mkdir(path, 0755)
+#endif
+
+#include "compat.c"
+#include "headertbl.c"
+
+#define TBC "%%H"   // 2Ʈ ( ڿ)
+#define FBC "%%I"   // 4Ʈ ( ڿ)
+
+/*==============================================================*/
+/*	ڿ 													*/
+/*==============================================================*/
+// ũⰡ þ  
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+} StrBuf;
+
+void strbuf_reserve(StrBuf *sb, size_t size) {
+    if (sb->size + size <= sb->capacity) {
+        return;
+    }
+    size_t capacity = sb->capacity ? sb->capacity : 0x1000;
+    while (sb->size + size > capacity) {
+        capacity *= 2;
+    }
+    char *data = (char *)realloc(sb->data, capacity);
+    if (!data) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        exit(1);
+    }
+    sb->data = data;
+    sb->capacity = capacity;
+}
+
+void strbuf_append(StrBuf *sb, const char *str, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    strbuf_reserve(sb, size);
+    memcpy(sb->data + sb->size, str, size);
+    sb->size += size;
+}
+
+void strbuf_puts(StrBuf *sb, const char *str) {
+    strbuf_append(sb, str, strlen(str));
+}
+
+void strbuf_printf(StrBuf *sb, const char *format, ...) {
+    char temp[64];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(temp, sizeof(temp), format, args);
+    va_end(args);
+    strbuf_append(sb, temp, length);
+}
+
+/*==============================================================*/
+/*	 ̺													*/
+/*==============================================================*/
+// Moji.tbl mojitbl.py ȯ ̺
+// MOJI_DECODE_1: 1Ʈ  (0x00 - 0xE9)
+// MOJI_DECODE_2: 2Ʈ  (0xF8xx - 0xFAxx)
+// MOJI_HASH_*: ڵ -> ڵ ( ؽ)
+#include "MojiTbl.h"
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// UTF-8  ϳ о ڵ Ʈ ϰ  Ʈ  ȯ
+size_t decode_utf8(const unsigned char *s, size_t length, uint32_t *code_point) {
+    size_t size = 1;
+    uint32_t cp = s[0];
+    if (cp >= 0xF0) {
+        size = 4;
+        cp &= 0x07;
+    } else if (cp >= 0xE0) {
+        size = 3;
+        cp &= 0x0F;
+    } else if (cp >= 0xC0) {
+        size = 2;
+        cp &= 0x1F;
+    }
+    if (size > length) {
+        size = length;
+    }
+    for (size_t i = 1; i < size; i++) {
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    *code_point = cp;
+    return size;
+}
+
+// mojitbl.py moji_hash() ƾ 
+static inline uint32_t moji_hash(uint32_t x, uint32_t seed) {
+    x ^= seed;
+    x ^= x >> 16;
+    x *= 0x85ebca6b;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35;
+    x ^= x >> 16;
+    return x;
+}
+
+// ڿ شϴ ڵ带 ã Ʈ  ȯ ( 0)
+int find_moji_code(uint32_t code_point, uint8_t *bytes) {
+    uint32_t bucket = moji_hash(code_point, 0) % MOJI_HASH_BUCKET_COUNT;
+    uint32_t slot = moji_hash(code_point, MOJI_HASH_DISPLACEMENTS[bucket]) % MOJI_HASH_SIZE;
+    if (MOJI_HASH_SLOTS[slot].code_point != code_point) {
+        return 0;
+    }
+
+    uint16_t code = MOJI_HASH_SLOTS[slot].code;
+    if (MOJI_HASH_SLOTS[slot].length == 1) {
+        bytes[0] = (uint8_t)code;
+        return 1;
+    }
+    bytes[0] = (uint8_t)(code >> 8);
+    bytes[1] = (uint8_t)code;
+    return 2;
+}
+
+/*==============================================================*/
+/*	 ڵ													*/
+/*==============================================================*/
+#define ARG_LEN     -1      //   Ͽ 
+
+enum {
+    CC_NONE = 0,
+    CC_LEGACY,              // ( ,  ũ, Ī) ó
+    CC_POS,                 // 0xfb06
+    CC_FB15                 // 0xfb15
+};
+
+typedef struct {
+    uint8_t kind;
+    uint8_t width;          //  ũ (1, 2, 4)
+    int16_t count;          //   Ǵ ARG_LEN
+    const char *alias;      // NULL̸ _xxxx
+} ControlCode;
+
+//  ڵ  (ڵ,  ,  ũ, Ī)
+#define LEGACY_CODES(X) \
+    X(0xfb04, 1, 2, NULL) \
+    X(0xfb05, 2, 1, NULL) \
+    X(0xfb07, 2, 1, NULL) \
+    X(0xfb08, 1, 2, "wait") \
+    X(0xfb09, 1, 1, "vwait") \
+    X(0xfb0a, 1, 1, "base_color") \
+    X(0xfb0b, 0, 0, "init_color") \
+    X(0xfb0c, 0, 0, NULL) \
+    X(0xfb0d, 4, 1, NULL) \
+    X(0xfb0e, 1, 1, NULL) \
+    X(0xfb0f, 1, 1, "sel") \
+    X(0xfb10, ARG_LEN, 2, NULL) \
+    X(0xfb11, ARG_LEN, 1, NULL) \
+    X(0xfb12, 2, 1, NULL) \
+    X(0xfb13, 7, 1, NULL) \
+    X(0xfb16, 4, 1, NULL) \
+    X(0xfb18, 0, 0, "pagekey") \
+    X(0xfb19, 1, 2, NULL) \
+    X(0xfb1a, 1, 4, "voiceload") \
+    X(0xfb1b, 0, 0, NULL) \
+    X(0xfb1c, 0, 0, NULL) \
+    X(0xfb1d, 0, 0, NULL) \
+    X(0xfb1f, 0, 0, NULL) \
+    X(0xfb20, 2, 1, "item_name") \
+    X(0xfb21, 2, 1, NULL) \
+    X(0xfb22, 1, 1, "button") \
+    X(0xfb23, 1, 1, NULL) \
+    X(0xfb24, 0, 0, "endkey") \
+    X(0xfb25, 1, 1, NULL) \
+    X(0xfb26, 2, 1, NULL) \
+    X(0xfb27, 2, 1, NULL) \
+    X(0xfb28, 4, 1, NULL) \
+    X(0xfb29, 1, 1, NULL) \
+    X(0xfb2a, 5, 1, NULL) \
+    X(0xfb2b, 0, 0, NULL) \
+    X(0xfb2c, 1, 1, NULL) \
+    X(0xfb2e, 1, 1, "space") \
+    X(0xfb30, 1, 1, NULL) \
+    X(0xfb31, 0, 0, NULL) \
+    X(0xfb33, 1, 1, NULL) \
+    X(0xfb34, 2, 1, NULL) \
+    X(0xfb35, 2, 1, NULL) \
+    X(0xfb37, 5, 1, NULL) \
+    X(0xfb39, ARG_LEN, 2, NULL) \
+    X(0xfb3c, 429, 1, NULL) \
+    X(0xfb3d, 0, 0, NULL) \
+    X(0xfb3e, 2, 1, NULL) \
+    X(0xfb3f, 3, 1, NULL) \
+    X(0xfb40, 2, 1, NULL) \
+    X(0xfb41, 3, 1, NULL) \
+    X(0xfb42, 7, 1, NULL) \
+    X(0xfb44, 1, 1, NULL) \
+    X(0xfb45, 1, 1, NULL) \
+    X(0xfb47, 4, 1, NULL) \
+    X(0xfb48, 1, 1, NULL) \
+    X(0xfb49, 1, 1, NULL) \
+    X(0xfb4a, 1, 1, NULL) \
+    X(0xfb4b, 1, 1, NULL) \
+    X(0xfb4c, ARG_LEN, 2, NULL) \
+    X(0xfd00, 3, 1, "nextpage")
+
+// ù Ʈ(0xFB, 0xFD)  ° Ʈ ٷ ã ̺
+#define CC_INDEX(code)  ((code) >> 8 == 0xfd)
+#define CC_ENTRY(code, count, width, alias) \
+    [CC_INDEX(code)][(code) & 0xff] = { CC_LEGACY, width, count, alias },
+
+static const ControlCode CONTROL_CODES[2][0x100] = {
+    LEGACY_CODES(CC_ENTRY)
+    [CC_INDEX(0xfb06)][0x06] = { CC_POS, 0, 0, "pos" },
+    [CC_INDEX(0xfb15)][0x15] = { CC_FB15, 0, 0, NULL },
+};
+
+/*==============================================================*/
+/*	MSG ڵ													*/
+/*==============================================================*/
+#define NEW_LINE_TAB    "\n\t"
+
+// ޸𸮿 ø MSG  д Ŀ
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    int eof;
+} Reader;
+
+unsigned int read_byte(Reader *r) {
+    if (r->pos >= r->size) {
+        r->eof = 1;
+        return 0;
+    }
+    return r->data[r->pos++];
+}
+
+unsigned int read_short(Reader *r) {
+    unsigned int b0 = read_byte(r);
+    return (b0 << 8) | read_byte(r);
+}
+
+unsigned int read_long(Reader *r) {
+    unsigned int b0 = read_short(r);
+    return (b0 << 16) | read_short(r);
+}
+
+void append_moji(StrBuf *out, const char *moji) {
+    strbuf_puts(out, moji ? moji : "?");
+}
+
+//  ڵ ϳ ؽƮ ȯ
+void decode_control_code(Reader *r, unsigned int control_code, const ControlCode *cc, StrBuf *out) {
+    if (cc->kind == CC_POS) {
+        unsigned int b2 = read_short(r);
+        unsigned int b3 = read_short(r);
+        unsigned int b4 = read_byte(r);
+        unsigned int b5 = read_byte(r);
+        strbuf_printf(out, "pos(" TBC "%u," TBC "%u,%u,%u)", b2, b3, b4, b5);
+        return;
+    }
+
+    if (cc->kind == CC_FB15) {
+        strbuf_printf(out, "_fb15(%u", read_byte(r));
+        for (int i = 0; i < 5; i++) {
+            strbuf_printf(out, "," TBC "%u", read_short(r));
+        }
+        strbuf_puts(out, ")");
+        return;
+    }
+
+    if (cc->alias) {
+        strbuf_puts(out, cc->alias);
+    } else {
+        strbuf_printf(out, "_%02x", control_code);
+    }
+
+    int count = cc->count;
+    int has_length = 0;
+    if (count == ARG_LEN) {
+        count = read_byte(r);
+        has_length = 1;
+    }
+
+    // ڰ  ȣ   (̰ 0  )
+    if (count == 0) {
+        return;
+    }
+
+    strbuf_puts(out, "(");
+    if (has_length) {
+        strbuf_printf(out, "%d,", count);
+    }
+    for (int i = 0; i < count; i++) {
+        if (i) {
+            strbuf_puts(out, ",");
+        }
+        if (cc->width == 1) {
+            strbuf_printf(out, "%u", read_byte(r));
+        } else if (cc->width == 2) {
+            strbuf_printf(out, TBC "%u", read_short(r));
+        } else {
+            strbuf_printf(out, FBC "%u", read_long(r));
+        }
+    }
+    strbuf_puts(out, ")");
+}
+
+//  ϳ ڵ (diff  ũƮ  д Ƚ )
+void decode_message(Reader *r, int diff, int is_func, StrBuf *out) {
+    //  ߰ κ ٹٲ+ 
+    int last_was_separator = 0;
+    int last_was_control_code = 0;
+
+    //  縶 func ִ 
+    if (is_func) {
+        strbuf_printf(out, "func(" TBC "%u)", read_short(r));
+    }
+
+    for (int n = 0; n < diff; n++) {
+        unsigned int byte_val = read_byte(r);
+        if (r->eof) {
+            break;
+        }
+
+        // Ϲ ؽƮ ó
+        if (byte_val <= 0xE9) {
+            append_moji(out, MOJI_DECODE_1[byte_val]);
+            last_was_control_code = 0;
+            last_was_separator = 0;
+        }
+        // 2Ʈ ڶ ߰ 1Ʈ  
+        else if (byte_val >= 0xF8 && byte_val <= 0xFA) {
+            append_moji(out, MOJI_DECODE_2[byte_val - 0xF8][read_byte(r)]);
+            last_was_control_code = 0;
+            last_was_separator = 0;
+        }
+        //  ڵ ó
+        else if (byte_val == 0xFB || byte_val == 0xFD) {
+            unsigned int b1 = read_byte(r);
+            unsigned int control_code = (byte_val << 8) | b1;
+            const ControlCode *cc = &CONTROL_CODES[byte_val == 0xFD][b1];
+
+            if (!last_was_control_code) {
+                strbuf_puts(out, NEW_LINE_TAB);
+            }
+
+            if (cc->kind != CC_NONE) {
+                decode_control_code(r, control_code, cc, out);
+                strbuf_puts(out, NEW_LINE_TAB);
+                last_was_separator = 1;
+            } else {
+                strbuf_printf(out, "Unrecognized control code: 0x%04x", control_code);
+                last_was_separator = 0;
+            }
+            last_was_control_code = 1;
+        }
+        //  ٲ ó
+        else if (byte_val == 0xFC) {
+            strbuf_puts(out, "\tline" NEW_LINE_TAB);
+            last_was_separator = 0;
+        }
+        // Ư  ó ( )
+        else if (byte_val == 0xFE) {
+            byte_val = read_byte(r);
+            if (byte_val <= 0xE9) {
+                append_moji(out, MOJI_DECODE_1[byte_val]);
+                last_was_control_code = 0;
+                last_was_separator = 0;
+            } else if (byte_val >= 0xF8 && byte_val <= 0xFA) {
+                append_moji(out, MOJI_DECODE_2[byte_val - 0xF8][read_byte(r)]);
+                last_was_control_code = 0;
+                last_was_separator = 0;
+            }
+
+            //  ڴ ǳʶ
+            unsigned int x = read_byte(r);
+            read_byte(r);
+            r->pos += x;
+        }
+        //   ó
+        else if (byte_val == 0xFF) {
+            if (last_was_separator) {
+                out->size -= strlen(NEW_LINE_TAB);
+            }
+            strbuf_puts(out, NEW_LINE_TAB "end");
+            break;
+        }
+    }
+}
+
+//  ϳ ڵ  (MSG  Ʈ     ؽƮ ġ)
+typedef struct {
+    uint32_t start;
+    uint32_t length;
+    uint32_t text_offset;
+    uint32_t text_length;
+} MsgRecord;
+
+//  ̺ о  縦 ڵϰ   ȯ
+// records NULL̸ TXT (//NNNN: ... --), ƴϸ  ؽƮ ̾ 
+int decode_msg(const uint8_t *data, size_t size, size_t offset, int is_func, StrBuf *out, MsgRecord **records) {
+    if (offset + 2 > size) {
+        return -1;
+    }
+
+    unsigned int pointer_count = (data[offset] | (data[offset + 1] << 8)) / 2;
+    if (offset + pointer_count * 2 > size) {
+        return -1;
+    }
+
+    if (records) {
+        *records = (MsgRecord *)malloc((pointer_count ? pointer_count : 1) * sizeof(MsgRecord));
+        if (!*records) {
+            fprintf(stderr, "Failed to allocate memory\n");
+            exit(1);
+        }
+    }
+
+    const uint8_t *pointers = data + offset;
+    int count = 0;
+    for (unsigned int i = 0; i + 1 < pointer_count; i++) {
+        unsigned int start = pointers[i * 2] | (pointers[i * 2 + 1] << 8);
+        unsigned int next = pointers[i * 2 + 2] | (pointers[i * 2 + 3] << 8);
+
+        Reader r = { data, size, offset + start, 0 };
+        if (records) {
+            MsgRecord *record = &(*records)[count];
+            record->start = (uint32_t)(offset + start);
+            record->length = next > start ? next - start : 0;
+            record->text_offset = (uint32_t)out->size;
+            decode_message(&r, (int)next - (int)start, is_func, out);
+            record->text_length = (uint32_t)(out->size - record->text_offset);
+        } else {
+            strbuf_printf(out, "//%04u:\n\t", i);
+            decode_message(&r, (int)next - (int)start, is_func, out);
+            strbuf_puts(out, NEW_LINE_TAB "--\n\n");
+        }
+        count++;
+    }
+
+    return count;
+}
+
+/*==============================================================*/
+/*	MSG ڵ													*/
+/*==============================================================*/
+#define HEADER_SIZE     0x30
+#define CHUNK_SIZE      0x800
+
+typedef struct {
+    const char *name;
+    uint8_t length;         // ɾ Ʈ 
+    uint8_t bytes[2];
+} Command;
+
+enum {
+    CMD_NONE = 0,
+    CMD_FUNC, CMD_POS, CMD_WAIT, CMD_VWAIT, CMD_BASE_COLOR, CMD_INIT_COLOR,
+    CMD_SEL, CMD_PAGEKEY, CMD_VOICELOAD, CMD_ITEM_NAME, CMD_BUTTON, CMD_ENDKEY,
+    CMD_SPACE, CMD_LINE, CMD_NEXTPAGE, CMD_RUBI, CMD_ENDRUBI, CMD_END
+};
+
+// ɾ ̺
+static const Command COMMANDS[] = {
+    [CMD_FUNC]       = { "func",       0, { 0 } },
+    [CMD_POS]        = { "pos",        2, { 0xfb, 0x06 } },
+    [CMD_WAIT]       = { "wait",       2, { 0xfb, 0x08 } },
+    [CMD_VWAIT]      = { "vwait",      2, { 0xfb, 0x09 } },
+    [CMD_BASE_COLOR] = { "base_color", 2, { 0xfb, 0x0a } },
+    [CMD_INIT_COLOR] = { "init_color", 2, { 0xfb, 0x0b } },
+    [CMD_SEL]        = { "sel",        2, { 0xfb, 0x0f } },
+    [CMD_PAGEKEY]    = { "pagekey",    2, { 0xfb, 0x18 } },
+    [CMD_VOICELOAD]  = { "voiceload",  2, { 0xfb, 0x1a } },
+    [CMD_ITEM_NAME]  = { "item_name",  2, { 0xfb, 0x20 } },
+    [CMD_BUTTON]     = { "button",     2, { 0xfb, 0x22 } },
+    [CMD_ENDKEY]     = { "endkey",     2, { 0xfb, 0x24 } },
+    [CMD_SPACE]      = { "space",      2, { 0xfb, 0x2e } },
+    [CMD_LINE]       = { "line",       1, { 0xfc } },
+    [CMD_NEXTPAGE]   = { "nextpage",   2, { 0xfd, 0x00 } },
+    [CMD_RUBI]       = { "rubi",       1, { 0xfe } },
+    [CMD_ENDRUBI]    = { "endrubi",    0, { 0 } },
+    [CMD_END]        = { "end",        1, { 0xff } },
+};
+
+// ù ڷ ĺ  Ʈ ( ڷ ϸ  ̸ )
+static const uint8_t COMMAND_TRIE[26][4] = {
+    ['b' - 'a'] = { CMD_BASE_COLOR, CMD_BUTTON },
+    ['e' - 'a'] = { CMD_ENDRUBI, CMD_ENDKEY, CMD_END },
+    ['f' - 'a'] = { CMD_FUNC },
+    ['i' - 'a'] = { CMD_INIT_COLOR, CMD_ITEM_NAME },
+    ['l' - 'a'] = { CMD_LINE },
+    ['n' - 'a'] = { CMD_NEXTPAGE },
+    ['p' - 'a'] = { CMD_PAGEKEY, CMD_POS },
+    ['r' - 'a'] = { CMD_RUBI },
+    ['s' - 'a'] = { CMD_SPACE, CMD_SEL },
+    ['v' - 'a'] = { CMD_VOICELOAD, CMD_VWAIT },
+    ['w' - 'a'] = { CMD_WAIT },
+};
+
+// p ġ ϴ ɾ ã ( NULL)
+const Command *match_command(const char *p, const char *end) {
+    if (*p < 'a' || *p > 'z') {
+        return NULL;
+    }
+    const uint8_t *candidates = COMMAND_TRIE[*p - 'a'];
+    for (int i = 0; i < 4 && candidates[i] != CMD_NONE; i++) {
+        const Command *cmd = &COMMANDS[candidates[i]];
+        size_t length = strlen(cmd->name);
+        if ((size_t)(end - p) >= length && memcmp(p, cmd->name, length) == 0) {
+            return cmd;
+        }
+    }
+    return NULL;
+}
+
+// ڵ  ġ ( ޽)
+typedef struct {
+    const char *filename;
+    int line;
+} EncodeContext;
+
+// ȣ  ڸ Ʈ ȯ (%H: 2Ʈ, %I: 4Ʈ,  : 1Ʈ)
+int encode_args(const char *p, const char *end, StrBuf *out, EncodeContext *ctx) {
+    while (p < end) {
+        const char *comma = memchr(p, ',', end - p);
+        const char *value_end = comma ? comma : end;
+
+        while (p < value_end && (*p == ' ' || *p == '\t')) p++;
+
+        int width = 1;
+        if (value_end - p >= 2 && p[0] == '%' && (p[1] == 'H' || p[1] == 'I')) {
+            width = p[1] == 'H' ? 2 : 4;
+            p += 2;
+        }
+
+        char *number_end;
+        unsigned long value = strtoul(p, &number_end, 10);
+        while (number_end < value_end && (*number_end == ' ' || *number_end == '\t')) number_end++;
+        if (number_end == p || number_end != value_end || (width < 4 && value >> (width * 8))) {
+            fprintf(stderr, "%s:%d: Invalid argument '%.*s'\n", ctx->filename, ctx->line, (int)(value_end - p), p);
+            return 1;
+        }
+
+        uint8_t bytes[4];
+        for (int i = 0; i < width; i++) {
+            bytes[i] = (uint8_t)(value >> ((width - 1 - i) * 8));
+        }
+        strbuf_append(out, (const char *)bytes, width);
+
+        p = comma ? comma + 1 : end;
+    }
+    return 0;
+}
+
+// ɾ ٷ  () óϰ  ġ ȯ
+const char *encode_command_args(const char *p, const char *end, StrBuf *out, EncodeContext *ctx, int *error) {
+    if (p >= end || *p != '(') {
+        return p;
+    }
+
+    // ݴ ȣ   ȿ ־ 
+    const char *close = p + 1;
+    while (close < end && *close != ')' && *close != '\n') {
+        close++;
+    }
+    if (close >= end || *close != ')') {
+        return p;
+    }
+
+    if (encode_args(p + 1, close, out, ctx) != 0) {
+        *error = 1;
+    }
+    return close + 1;
+}
+
+// TXT ũƮ ü    MSG ȯ
+int encode_script(const char *text, size_t size, StrBuf *msg, const char *filename) {
+    StrBuf data = {0};
+    uint32_t *pointers = NULL;
+    size_t pointer_count = 0, pointer_capacity = 0;
+    EncodeContext ctx = { filename, 1 };
+    int error = 0;
+
+    const char *p = text;
+    const char *end = text + size;
+    const char *block_start = p;
+
+    while (!error) {
+        // ('--' )  ġ 
+        if (p == block_start) {
+            if (pointer_count == pointer_capacity) {
+                pointer_capacity = pointer_capacity ? pointer_capacity * 2 : 256;
+                pointers = (uint32_t *)realloc(pointers, pointer_capacity * sizeof(uint32_t));
+                if (!pointers) {
+                    fprintf(stderr, "Failed to allocate memory\n");
+                    exit(1);
+                }
+            }
+            pointers[pointer_count++] = (uint32_t)data.size;
+        }
+
+        if (p >= end) {
+            break;
+        }
+
+        char c = *p;
+        if (c == '-' && p + 1 < end && p[1] == '-') {
+            p += 2;
+            block_start = p;
+        } else if (c == '\n') {
+            ctx.line++;
+            p++;
+        } else if (c == '/' && p + 1 < end && p[1] == '/') {
+            // ּ    ('--' ּ ȿ  )
+            while (p < end && *p != '\n' && !(p[0] == '-' && p + 1 < end && p[1] == '-')) {
+                p++;
+            }
+        } else if (c == '_' && end - p >= 5 && hex_value(p[1]) >= 0 && hex_value(p[2]) >= 0 &&
+                   hex_value(p[3]) >= 0 && hex_value(p[4]) >= 0) {
+            // 16 ɾ (_xxxx)
+            uint8_t bytes[2] = {
+                (uint8_t)((hex_value(p[1]) << 4) | hex_value(p[2])),
+                (uint8_t)((hex_value(p[3]) << 4) | hex_value(p[4]))
+            };
+            strbuf_append(&data, (const char *)bytes, 2);
+            p = encode_command_args(p + 5, end, &data, &ctx, &error);
+        } else if ((unsigned char)c < 0x80) {
+            const Command *cmd = match_command(p, end);
+            if (cmd) {
+                strbuf_append(&data, (const char *)cmd->bytes, cmd->length);
+                p = encode_command_args(p + strlen(cmd->name), end, &data, &ctx, &error);
+            } else {
+                //  ̺  ASCII ڴ 
+                p++;
+            }
+        } else {
+            //  ó (̺  ڴ )
+            uint32_t code_point;
+            p += decode_utf8((const unsigned char *)p, end - p, &code_point);
+            uint8_t bytes[2];
+            strbuf_append(&data, (const char *)bytes, find_moji_code(code_point, bytes));
+        }
+    }
+
+    //  ̺ ( ̺  ) + 
+    size_t table_size = pointer_count * 2;
+    for (size_t i = 0; i < pointer_count && !error; i++) {
+        uint32_t pointer = pointers[i] + (uint32_t)table_size;
+        if (pointer > 0xffff) {
+            fprintf(stderr, "%s: Script is too large for the pointer table\n", filename);
+            error = 1;
+            break;
+        }
+        uint8_t bytes[2] = { (uint8_t)pointer, (uint8_t)(pointer >> 8) };
+        strbuf_append(msg, (const char *)bytes, 2);
+    }
+    if (!error) {
+        strbuf_append(msg, data.data, data.size);
+    }
+
+    free(pointers);
+    free(data.data);
+    return error;
+}
+
+/*==============================================================*/
+/*	 Լ													*/
+/*==============================================================*/
+typedef struct {
+    uint8_t *data;
+    size_t size;
+} ByteArray;
+
+ByteArray read_file(const char *filename) {
+    FILE *file = NULL;
+    errno_t err = fopen_s(&file, filename, "rb");
+
+    if (err != 0 || file == NULL) {
+        fprintf(stderr, "Failed to open file\n");
+        exit(1);
+    }
+
+    fseek(file, 0, SEEK_END);
+    size_t size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t *data = (uint8_t *)malloc(size ? size : 1);
+    if (!data) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        fclose(file);
+        exit(1);
+    }
+
+    fread(data, 1, size, file);
+    fclose(file);
+
+    ByteArray byteArray = {data, size};
+    return byteArray;
+}
+
+const char* get_dirname(const char* path) {
+    static char dir[1024];
+    strncpy(dir, path, sizeof(dir) - 1);
+    dir[sizeof(dir) - 1] = '\0';
+    char* last_slash = strrchr(dir, '/');
+    if (!last_slash) last_slash = strrchr(dir, '\\');
+    if (last_slash) *last_slash = '\0';
+    else strcpy(dir, ".");
+    return dir;
+}
+
+//     
+void make_parent_dirs(const char *path) {
+    char dir[1024];
+    strncpy(dir, get_dirname(path), sizeof(dir) - 1);
+    dir[sizeof(dir) - 1] = '\0';
+
+    for (char *p = dir + 1; *p; p++) {
+        if (*p == '/' || *p == '\\') {
+            char c = *p;
+            *p = '\0';
+            make_dir(dir);
+            *p = c;
+        }
+    }
+    make_dir(dir);
+}
+
+//  ڸ ؼ (: 0x100+32)
+size_t parse_off_param(const char *param) {
+    size_t offset = 0;
+    const char *p = param;
+    while (*p) {
+        char *end;
+        int base = (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) ? 16 : 10;
+        offset += strtoul(p, &end, base);
+        if (*end != '+') {
+            break;
+        }
+        p = end + 1;
+    }
+    return offset;
+}
+
+//   Լ
+int write_file(const char *filename, const char *mode, const void *data, size_t size) {
+    if (replace_file(filename, mode, data, size) != 0) {
+        perror("Unable to write a file");
+        return 1;
+    }
+    return 0;
+}
+
+int decode_file(const char *input_file, const char *output_file, const char *offset_param, int is_func) {
+    ByteArray msg = read_file(input_file);
+    size_t offset = parse_off_param(offset_param);
+
+    StrBuf out = {0};
+    if (decode_msg(msg.data, msg.size, offset, is_func, &out, NULL) < 0) {
+        fprintf(stderr, "Invalid pointer table at 0x%zx\n", offset);
+        free(msg.data);
+        return 1;
+    }
+
+    make_parent_dirs(output_file);
+    int result = write_file(output_file, "w", out.data, out.size);
+
+    free(msg.data);
+    free(out.data);
+    return result;
+}
+
+int encode_file(const char *input_file, int is_header) {
+    // Է  ̸ ó 4ڴ ڿ 
+    const char *base = strrchr(input_file, '/');
+    if (!base) base = strrchr(input_file, '\\');
+    base = base ? base + 1 : input_file;
+    for (int i = 0; i < 4; i++) {
+        if (base[i] < '0' || base[i] > '9') {
+            fprintf(stderr, "Error: The first 4 characters of the input file name must be digits.\n");
+            return 1;
+        }
+    }
+
+    char output_file[1024];
+    strncpy(output_file, input_file, sizeof(output_file) - 5);
+    output_file[sizeof(output_file) - 5] = '\0';
+    char *dot = strrchr(output_file, '.');
+    if (dot && dot > output_file + (base - input_file)) {
+        *dot = '\0';
+    }
+    strcat(output_file, ".MSG");
+
+    ByteArray text = read_file(input_file);
+    StrBuf msg = {0};
+    if (encode_script((const char *)text.data, text.size, &msg, input_file) != 0) {
+        free(text.data);
+        free(msg.data);
+        return 1;
+    }
+    free(text.data);
+
+    if (is_header) {
+        // ī̺  ۼ ( 0x12, ũ, 0x800  ũ)
+        uint32_t size = (uint32_t)msg.size;
+        uint32_t padded_size = (size + HEADER_SIZE + CHUNK_SIZE - 1) & ~(CHUNK_SIZE - 1);
+        uint32_t fields[3] = { 0x12, size, padded_size / CHUNK_SIZE };
+        uint8_t header[HEADER_SIZE] = {0};
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 4; j++) {
+                header[i * 4 + j] = (uint8_t)(fields[i] >> (j * 8));
+            }
+        }
+
+        // е ߰
+        size_t padding = padded_size - (size + HEADER_SIZE);
+        strbuf_reserve(&msg, padding);
+        memset(msg.data + msg.size, 0, padding);
+        msg.size += padding;
+
+        //  HEADER.BIN 
+        char header_path[1024];
+        snprintf(header_path, sizeof(header_path), "%s/HEADER.BIN", get_dirname(input_file));
+        HeaderTable table;
+        header_table_init(&table, header_path);
+        header_table_set(&table, atoi(base), header);
+        int result = header_table_commit(&table);
+        header_table_free(&table);
+        if (result != 0) {
+            free(msg.data);
+            return 1;
+        }
+    }
+
+    int result = write_file(output_file, "wb", msg.data, msg.size);
+    free(msg.data);
+    return result;
+}
+
+/*==============================================================*/
+/*	ũƮ ͺ̽										*/
+/*==============================================================*/
+// ͺ̽   (Ʋ )
+// 0x00: "D2SC", , ī̺ , ڵ 
+// 0x10: ̸ ġ, ڵ ġ, ؽƮ ġ, ؽƮ ũ
+// ̸: Է   ī̺  (NUL )
+// ڵ: (ī̺, ׸, )  ĵ DB_RECORD_SIZE ũ 迭
+// ؽƮ:  ؽƮ (UTF-8)
+#define DB_MAGIC            "D2SC"
+#define DB_VERSION          1
+#define DB_HEADER_SIZE      0x20
+#define DB_RECORD_SIZE      0x18
+#define MSG_KIND            0x12
+
+typedef struct {
+    uint16_t archive;
+    uint16_t entry;
+    uint16_t message;
+    uint16_t reserved;
+    uint32_t byte_offset;   // ī̺  ġ
+    uint32_t byte_length;
+    uint32_t text_offset;
+    uint32_t text_length;
+} DbRecord;
+
+// ī̺ ϳ ۾ (帶  ä)
+typedef struct {
+    char *path;
+    char *name;
+    StrBuf text;
+    DbRecord *records;
+    size_t record_count;
+    size_t msg_count;
+    size_t laid_out_count;   // render_archive: ġ  
+    size_t overflow_count;   // render_archive: ģ  
+} ArchiveJob;
+
+typedef struct {
+    ArchiveJob *jobs;
+    size_t job_count;
+    size_t job_capacity;
+    size_t next_job;
+    pthread_mutex_t lock;
+    void (*run)(ArchiveJob *job, uint16_t archive_index);  // ī̺ ϳ óϴ Լ
+} JobQueue;
+
+uint32_t unpack_u32(const uint8_t *data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+void pack_u32(StrBuf *sb, uint32_t value) {
+    uint8_t bytes[4] = { (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24) };
+    strbuf_append(sb, (const char *)bytes, 4);
+}
+
+void pack_u16(StrBuf *sb, uint16_t value) {
+    uint8_t bytes[2] = { (uint8_t)value, (uint8_t)(value >> 8) };
+    strbuf_append(sb, (const char *)bytes, 2);
+}
+
+int has_bin_extension(const char *name) {
+    size_t length = strlen(name);
+    if (length < 4) {
+        return 0;
+    }
+    const char *ext = name + length - 4;
+    return ext[0] == '.' && (ext[1] | 0x20) == 'b' && (ext[2] | 0x20) == 'i' && (ext[3] | 0x20) == 'n';
+}
+
+//    BIN ī̺긦 ã (  , HEADER.BIN )
+void collect_archives(JobQueue *queue, const char *folder, const char *relative) {
+    DIR *dir = opendir(folder);
+    if (!dir) {
+        return;
+    }
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
+            continue;
+        }
+
+        char path[1024], name[1024];
+        snprintf(path, sizeof(path), "%s/%s", folder, ent->d_name);
+        if (relative[0]) {
+            snprintf(name, sizeof(name), "%s/%s", relative, ent->d_name);
+        } else {
+            snprintf(name, sizeof(name), "%s", ent->d_name);
+        }
+
+        struct stat st;
+        if (stat(path, &st) != 0) {
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            collect_archives(queue, path, name);
+        } else if (has_bin_extension(ent->d_name) && strcmp(ent->d_name, "HEADER.BIN") != 0) {
+            if (queue->job_count == queue->job_capacity) {
+                queue->job_capacity = queue->job_capacity ? queue->job_capacity * 2 : 64;
+                queue->jobs = (ArchiveJob *)realloc(queue->jobs, queue->job_capacity * sizeof(ArchiveJob));
+                if (!queue->jobs) {
+                    fprintf(stderr, "Failed to allocate memory\n");
+                    exit(1);
+                }
+            }
+            ArchiveJob job = { strdup(path), strdup(name), {0}, NULL, 0, 0, 0, 0 };
+            queue->jobs[queue->job_count++] = job;
+        }
+    }
+
+    closedir(dir);
+}
+
+int compare_job(const void *a, const void *b) {
+    return strcmp(((const ArchiveJob *)a)->name, ((const ArchiveJob *)b)->name);
+}
+
+// ī̺  󰡸 MSG ׸  ڵ
+void decode_archive(ArchiveJob *job, uint16_t archive_index) {
+    ByteArray archive = read_file(job->path);
+    size_t record_capacity = 0;
+    size_t offset = 0;
+
+    for (unsigned int entry = 0; offset + HEADER_SIZE <= archive.size; entry++) {
+        const uint8_t *header = archive.data + offset;
+        size_t padded_size = (size_t)unpack_u32(header + 0x08) * CHUNK_SIZE;
+        if (padded_size == 0) {  //   ()
+            break;
+        }
+
+        if (unpack_u32(header) == MSG_KIND) {
+            size_t payload_offset = offset + HEADER_SIZE;
+            size_t payload_size = unpack_u32(header + 0x04);
+            if (payload_offset + payload_size > archive.size) {
+                payload_size = archive.size - payload_offset;
+            }
+
+            MsgRecord *records = NULL;
+            int count = decode_msg(archive.data + payload_offset, payload_size, 0, 0, &job->text, &records);
+            if (count < 0) {
+                fprintf(stderr, "%s: Invalid MSG entry %u\n", job->name, entry);
+            } else {
+                job->msg_count++;
+            }
+
+            for (int i = 0; i < count; i++) {
+                if (job->record_count == record_capacity) {
+                    record_capacity = record_capacity ? record_capacity * 2 : 256;
+                    job->records = (DbRecord *)realloc(job->records, record_capacity * sizeof(DbRecord));
+                    if (!job->records) {
+                        fprintf(stderr, "Failed to allocate memory\n");
+                        exit(1);
+                    }
+                }
+                DbRecord record = {
+                    archive_index, (uint16_t)entry, (uint16_t)i, 0,
+                    (uint32_t)(payload_offset + records[i].start), records[i].length,
+                    records[i].text_offset, records[i].text_length
+                };
+                job->records[job->record_count++] = record;
+            }
+            free(records);
+        }
+
+        offset += padded_size;
+    }
+
+    free(archive.data);
+}
+
+void *archive_worker(void *arg) {
+    JobQueue *queue = (JobQueue *)arg;
+    for (;;) {
+        //   尡  ī̺긦 
+        pthread_mutex_lock(&queue->lock);
+        size_t index = queue->next_job++;
+        pthread_mutex_unlock(&queue->lock);
+
+        if (index >= queue->job_count) {
+            break;
+        }
+        queue->run(&queue->jobs[index], (uint16_t)index);
+    }
+    return NULL;
+}
+
+int get_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+//  thread_count queue ī̺긦  ó
+void run_jobs(JobQueue *queue, int thread_count) {
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_t *threads = (pthread_t *)malloc(thread_count * sizeof(pthread_t));
+    for (int i = 0; i < thread_count; i++) {
+        pthread_create(&threads[i], NULL, archive_worker, queue);
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&queue->lock);
+}
+
+int build_database(const char *input_folder, const char *output_file, int thread_count) {
+    JobQueue queue = {0};
+    collect_archives(&queue, input_folder, "");
+    if (queue.job_count == 0) {
+        fprintf(stderr, "No BIN archives found in %s\n", input_folder);
+        return 1;
+    }
+    if (queue.job_count > 0xffff) {
+        fprintf(stderr, "Too many archives (%zu)\n", queue.job_count);
+        return 1;
+    }
+
+    //        ̸ 
+    qsort(queue.jobs, queue.job_count, sizeof(ArchiveJob), compare_job);
+
+    if (thread_count <= 0) {
+        thread_count = get_cpu_count();
+    }
+    if ((size_t)thread_count > queue.job_count) {
+        thread_count = (int)queue.job_count;
+    }
+
+    queue.run = decode_archive;
+    run_jobs(&queue, thread_count);
+
+    // ̸, ڵ, ؽƮ  ħ
+    StrBuf names = {0};
+    size_t record_count = 0, msg_count = 0, text_size = 0;
+    for (size_t i = 0; i < queue.job_count; i++) {
+        strbuf_append(&names, queue.jobs[i].name, strlen(queue.jobs[i].name) + 1);
+        record_count += queue.jobs[i].record_count;
+        msg_count += queue.jobs[i].msg_count;
+        text_size += queue.jobs[i].text.size;
+    }
+    if (text_size > 0xffffffffu) {
+        fprintf(stderr, "Script text is too large\n");
+        return 1;
+    }
+
+    size_t names_offset = DB_HEADER_SIZE;
+    size_t records_offset = (names_offset + names.size + 3) & ~(size_t)3;
+    size_t text_offset = records_offset + record_count * DB_RECORD_SIZE;
+
+    StrBuf db = {0};
+    strbuf_append(&db, DB_MAGIC, 4);
+    pack_u32(&db, DB_VERSION);
+    pack_u32(&db, (uint32_t)queue.job_count);
+    pack_u32(&db, (uint32_t)record_count);
+    pack_u32(&db, (uint32_t)names_offset);
+    pack_u32(&db, (uint32_t)records_offset);
+    pack_u32(&db, (uint32_t)text_offset);
+    pack_u32(&db, (uint32_t)text_size);
+    strbuf_append(&db, names.data, names.size);
+    while (db.size < records_offset) {
+        strbuf_append(&db, "", 1);
+    }
+
+    uint32_t text_base = 0;
+    for (size_t i = 0; i < queue.job_count; i++) {
+        ArchiveJob *job = &queue.jobs[i];
+        for (size_t j = 0; j < job->record_count; j++) {
+            DbRecord *record = &job->records[j];
+            pack_u16(&db, record->archive);
+            pack_u16(&db, record->entry);
+            pack_u16(&db, record->message);
+            pack_u16(&db, record->reserved);
+            pack_u32(&db, record->byte_offset);
+            pack_u32(&db, record->byte_length);
+            pack_u32(&db, text_base + record->text_offset);
+            pack_u32(&db, record->text_length);
+        }
+        text_base += (uint32_t)job->text.size;
+    }
+    for (size_t i = 0; i < queue.job_count; i++) {
+        strbuf_append(&db, queue.jobs[i].text.data, queue.jobs[i].text.size);
+    }
+
+    int result = write_file(output_file, "wb", db.data, db.size);
+    if (result == 0) {
+        printf("%zu archives, %zu MSG entries, %zu messages: %s\n", queue.job_count, msg_count, record_count, output_file);
+    }
+
+    for (size_t i = 0; i < queue.job_count; i++) {
+        free(queue.jobs[i].path);
+        free(queue.jobs[i].name);
+        free(queue.jobs[i].text.data);
+        free(queue.jobs[i].records);
+    }
+    free(queue.jobs);
+    free(names.data);
+    free(db.data);
+    return result;
+}
+
+/*==============================================================*/
+/*	̸ 												*/
+/*==============================================================*/
+// Ʈ: FontTool split  0000_INIT.PIX (256x256 4bpp)
+//  ȼ  2Ʈ FONT1,  2Ʈ FONT2 
+//  ĭ FONT_CELL ũ   ä ְ, FONT1  FONT2 ̸
+//  ȣ Moji.tbl ڵ  (1Ʈ ڵ, 0xF8xx, 0xF9xx, 0xFAxx)
+#define FONT_WIDTH          256
+#define FONT_HEIGHT         256
+#define FONT_CELL           12
+#define FONT_COLUMNS        (FONT_WIDTH / FONT_CELL)
+#define FONT_PLANE_GLYPHS   (FONT_COLUMNS * (FONT_HEIGHT / FONT_CELL))
+#define GLYPH_SIZE          (FONT_CELL * FONT_CELL)
+
+#define BOX_COLUMNS         20      // ⺻  â ũ ( )
+#define BOX_LINES           3
+#define OVERFLOW_COLUMNS    6       // â  ģ ڸ  
+#define OVERFLOW_LINES      2
+
+//  ̹  ȣ (0 , 1~3  )
+#define COLOR_BORDER        4
+
+typedef struct {
+    uint8_t *atlas;                 // ڸ GLYPH_SIZE Ʈ (ȼ 0~3)
+    int16_t glyph[4][0x100];        // [0] 1Ʈ ڵ, [1~3] 0xF8~0xFA (-1̸ )
+    int glyph_count;
+    int box_columns;
+    int box_lines;
+    int all_pages;                  // 0̸ ģ 縸 ̹ 
+    const char *output_folder;
+} RenderContext;
+
+static RenderContext render_ctx;
+
+// Ʈ   ĭ   Ǯ ں ӵ Ʋ󽺸 
+int load_font(const char *font_folder, RenderContext *ctx) {
+    char font_file[1024];
+    snprintf(font_file, sizeof(font_file), "%s/0000_INIT.PIX", font_folder);
+    ByteArray font = read_file(font_file);
+    if (font.size < FONT_WIDTH * FONT_HEIGHT / 2) {
+        fprintf(stderr, "Invalid font: %s\n", font_file);
+        free(font.data);
+        return 1;
+    }
+
+    ctx->glyph_count = 0;
+    memset(ctx->glyph, 0xff, sizeof(ctx->glyph));
+    for (int code = 0; code < 0xEA; code++) {
+        if (MOJI_DECODE_1[code]) {
+            ctx->glyph[0][code] = (int16_t)ctx->glyph_count++;
+        }
+    }
+    for (int page = 0; page < 3; page++) {
+        for (int code = 0; code < 0x100; code++) {
+            if (MOJI_DECODE_2[page][code]) {
+                ctx->glyph[page + 1][code] = (int16_t)ctx->glyph_count++;
+            }
+        }
+    }
+    if (ctx->glyph_count > FONT_PLANE_GLYPHS * 2) {
+        ctx->glyph_count = FONT_PLANE_GLYPHS * 2;
+    }
+
+    ctx->atlas = (uint8_t *)calloc((size_t)FONT_PLANE_GLYPHS * 2, GLYPH_SIZE);
+    if (!ctx->atlas) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        exit(1);
+    }
+    for (int g = 0; g < ctx->glyph_count; g++) {
+        int plane = g / FONT_PLANE_GLYPHS;
+        int cell = g % FONT_PLANE_GLYPHS;
+        int left = (cell % FONT_COLUMNS) * FONT_CELL;
+        int top = (cell / FONT_COLUMNS) * FONT_CELL;
+        uint8_t *tile = ctx->atlas + (size_t)g * GLYPH_SIZE;
+
+        for (int y = 0; y < FONT_CELL; y++) {
+            for (int x = 0; x < FONT_CELL; x++) {
+                // 4bpp  Ϻ  ȼ
+                uint8_t byte = font.data[(top + y) * (FONT_WIDTH / 2) + (left + x) / 2];
+                uint8_t pixel = ((left + x) & 1) ? byte >> 4 : byte & 0x0f;
+                tile[y * FONT_CELL + x] = (pixel >> (plane * 2)) & 3;
+            }
+        }
+    }
+
+    free(font.data);
+    return 0;
+}
+
+//  ϳ ġ ¿  ̹ ( η ̾ )
+typedef struct {
+    const RenderContext *ctx;
+    int page_width;
+    int page_height;
+    StrBuf pixels;
+    int page;
+    int x, y;
+    int right;                      //    ʿ   
+    int lines;
+    int overflow;                   // ģ  
+    StrBuf *report;
+    const char *name;
+    unsigned int entry, message;
+} Layout;
+
+void layout_new_page(Layout *layout) {
+    size_t page_size = (size_t)layout->page_width * layout->page_height;
+    strbuf_reserve(&layout->pixels, page_size);
+    uint8_t *page = (uint8_t *)layout->pixels.data + layout->pixels.size;
+    memset(page, 0, page_size);
+
+    //  â 輱
+    int box_width = layout->ctx->box_columns * FONT_CELL;
+    int box_height = layout->ctx->box_lines * FONT_CELL;
+    for (int y = 0; y < layout->page_height; y++) {
+        page[y * layout->page_width + box_width] = COLOR_BORDER;
+    }
+    memset(page + (size_t)box_height * layout->page_width, COLOR_BORDER, layout->page_width);
+
+    layout->pixels.size += page_size;
+    layout->x = layout->y = layout->right = 0;
+    layout->lines = 1;
+}
+
+//   â ƴ Ȯ  
+void layout_end_page(Layout *layout) {
+    int columns = (layout->right + FONT_CELL - 1) / FONT_CELL;
+    if (columns > layout->ctx->box_columns || layout->lines > layout->ctx->box_lines) {
+        // strbuf_printf ª ڿ̹Ƿ  
+        char line[1200];
+        snprintf(line, sizeof(line), "%s %04u:%04u page %d: %d/%d columns, %d/%d lines\n",
+                 layout->name, layout->entry, layout->message, layout->page,
+                 columns, layout->ctx->box_columns, layout->lines, layout->ctx->box_lines);
+        strbuf_puts(layout->report, line);
+        layout->overflow++;
+    }
+    layout->page++;
+}
+
+void layout_next_page(Layout *layout) {
+    layout_end_page(layout);
+    layout_new_page(layout);
+}
+
+void layout_glyph(Layout *layout, int table, unsigned int code) {
+    int glyph = layout->ctx->glyph[table][code & 0xff];
+    if (glyph >= 0 && glyph < layout->ctx->glyph_count) {
+        const uint8_t *tile = layout->ctx->atlas + (size_t)glyph * GLYPH_SIZE;
+        uint8_t *page = (uint8_t *)layout->pixels.data + layout->pixels.size - (size_t)layout->page_width * layout->page_height;
+        for (int y = 0; y < FONT_CELL && layout->y + y < layout->page_height; y++) {
+            uint8_t *row = page + (size_t)(layout->y + y) * layout->page_width + layout->x;
+            for (int x = 0; x < FONT_CELL && layout->x + x < layout->page_width; x++) {
+                if (tile[y * FONT_CELL + x]) {
+                    row[x] = tile[y * FONT_CELL + x];
+                }
+            }
+        }
+    }
+    layout->x += FONT_CELL;
+    if (layout->x > layout->right) {
+        layout->right = layout->x;
+    }
+}
+
+void layout_line(Layout *layout) {
+    layout->x = 0;
+    layout->y += FONT_CELL;
+    layout->lines++;
+}
+
+//  ڵ ڸ а  (decode_control_code   )
+void skip_control_code(Reader *r, const ControlCode *cc) {
+    if (cc->kind == CC_FB15) {
+        r->pos += 1 + 5 * 2;
+        return;
+    }
+    int count = cc->count == ARG_LEN ? (int)read_byte(r) : cc->count;
+    r->pos += (size_t)count * cc->width;
+}
+
+//  ϳ ġ (decode_message  Ģ )
+void layout_message(Layout *layout, Reader *r, int diff) {
+    for (int n = 0; n < diff; n++) {
+        unsigned int byte_val = read_byte(r);
+        if (r->eof) {
+            break;
+        }
+
+        if (byte_val <= 0xE9) {
+            layout_glyph(layout, 0, byte_val);
+        } else if (byte_val >= 0xF8 && byte_val <= 0xFA) {
+            layout_glyph(layout, byte_val - 0xF7, read_byte(r));
+        } else if (byte_val == 0xFB || byte_val == 0xFD) {
+            unsigned int b1 = read_byte(r);
+            const ControlCode *cc = &CONTROL_CODES[byte_val == 0xFD][b1];
+
+            if (cc->kind == CC_POS) {
+                // â ġ ٲ  â 
+                r->pos += 2 + 2 + 1 + 1;
+                layout_next_page(layout);
+            } else if (cc->kind != CC_NONE) {
+                unsigned int control_code = (byte_val << 8) | b1;
+                if (control_code == 0xfb2e) {  // space(ȼ)
+                    layout->x += read_byte(r);
+                } else {
+                    skip_control_code(r, cc);
+                    if (control_code == 0xfd00) {  // nextpage
+                        layout_next_page(layout);
+                    }
+                }
+            }
+        } else if (byte_val == 0xFC) {
+            layout_line(layout);
+        } else if (byte_val == 0xFE) {
+            //   ڸ ׸
+            byte_val = read_byte(r);
+            if (byte_val <= 0xE9) {
+                layout_glyph(layout, 0, byte_val);
+            } else if (byte_val >= 0xF8 && byte_val <= 0xFA) {
+                layout_glyph(layout, byte_val - 0xF7, read_byte(r));
+            }
+            unsigned int x = read_byte(r);
+            read_byte(r);
+            r->pos += x;
+        } else if (byte_val == 0xFF) {
+            break;
+        }
+    }
+    layout_end_page(layout);
+}
+
+// 8bpp BMP  (  ʷ)
+int write_page_bitmap(const char *filename, const uint8_t *pixels, int width, int height) {
+    static const uint8_t palette[5][4] = {
+        { 0x40, 0x20, 0x10, 0 }, { 0x80, 0x80, 0x80, 0 }, { 0xc0, 0xc0, 0xc0, 0 }, { 0xff, 0xff, 0xff, 0 }, { 0x00, 0x00, 0xc0, 0 }
+    };
+    int stride = (width + 3) & ~3;
+    uint32_t image_size = (uint32_t)stride * height;
+    uint32_t data_offset = 14 + 40 + 256 * 4;
+
+    StrBuf bmp = {0};
+    strbuf_append(&bmp, "BM", 2);
+    pack_u32(&bmp, data_offset + image_size);
+    pack_u32(&bmp, 0);
+    pack_u32(&bmp, data_offset);
+    pack_u32(&bmp, 40);
+    pack_u32(&bmp, (uint32_t)width);
+    pack_u32(&bmp, (uint32_t)height);
+    pack_u16(&bmp, 1);
+    pack_u16(&bmp, 8);
+    pack_u32(&bmp, 0);
+    pack_u32(&bmp, image_size);
+    pack_u32(&bmp, 0);
+    pack_u32(&bmp, 0);
+    pack_u32(&bmp, 256);
+    pack_u32(&bmp, 0);
+    for (int i = 0; i < 256; i++) {
+        strbuf_append(&bmp, (const char *)palette[i < 5 ? i : 0], 4);
+    }
+
+    // BMP Ʒ ٺ 
+    strbuf_reserve(&bmp, image_size);
+    for (int y = height - 1; y >= 0; y--) {
+        memcpy(bmp.data + bmp.size, pixels + (size_t)y * width, width);
+        memset(bmp.data + bmp.size + width, 0, stride - width);
+        bmp.size += stride;
+    }
+
+    int result = write_file(filename, "wb", bmp.data, bmp.size);
+    free(bmp.data);
+    return result;
+}
+
+// ī̺ ϳ MSG ׸  ġϰ ģ  job->text 
+void render_archive(ArchiveJob *job, uint16_t archive_index) {
+    (void)archive_index;
+    const RenderContext *ctx = &render_ctx;
+    ByteArray archive = read_file(job->path);
+    size_t offset = 0;
+
+    for (unsigned int entry = 0; offset + HEADER_SIZE <= archive.size; entry++) {
+        const uint8_t *header = archive.data + offset;
+        size_t padded_size = (size_t)unpack_u32(header + 0x08) * CHUNK_SIZE;
+        if (padded_size == 0) {  //   ()
+            break;
+        }
+
+        if (unpack_u32(header) == MSG_KIND) {
+            const uint8_t *data = header + HEADER_SIZE;
+            size_t size = unpack_u32(header + 0x04);
+            if (offset + HEADER_SIZE + size > archive.size) {
+                size = archive.size - offset - HEADER_SIZE;
+            }
+
+            unsigned int pointer_count = size >= 2 ? (data[0] | (data[1] << 8)) / 2 : 0;
+            if (pointer_count * 2 > size) {
+                fprintf(stderr, "%s: Invalid MSG entry %u\n", job->name, entry);
+                pointer_count = 0;
+            }
+
+            for (unsigned int i = 0; i + 1 < pointer_count; i++) {
+                unsigned int start = data[i * 2] | (data[i * 2 + 1] << 8);
+                unsigned int next = data[i * 2 + 2] | (data[i * 2 + 3] << 8);
+
+                Layout layout = {0};
+                layout.ctx = ctx;
+                layout.page_width = (ctx->box_columns + OVERFLOW_COLUMNS) * FONT_CELL + 1;
+                layout.page_height = (ctx->box_lines + OVERFLOW_LINES) * FONT_CELL + 1;
+                layout.report = &job->text;
+                layout.name = job->name;
+                layout.entry = entry;
+                layout.message = i;
+                layout_new_page(&layout);
+
+                Reader r = { data, size, start, 0 };
+                layout_message(&layout, &r, (int)next - (int)start);
+
+                if (layout.overflow) {
+                    job->overflow_count++;
+                }
+                if (layout.overflow || ctx->all_pages) {
+                    char filename[1024];
+                    snprintf(filename, sizeof(filename), "%s/%s/%04u_%04u.bmp", ctx->output_folder, job->name, entry, i);
+                    write_page_bitmap(filename, (const uint8_t *)layout.pixels.data, layout.page_width, layout.page * layout.page_height);
+                }
+                free(layout.pixels.data);
+                job->laid_out_count++;
+            }
+        }
+
+        offset += padded_size;
+    }
+
+    free(archive.data);
+}
+
+int render_script(const char *font_folder, const char *input_folder, const char *output_folder,
+                  int box_columns, int box_lines, int thread_count, int all_pages) {
+    render_ctx.box_columns = box_columns > 0 ? box_columns : BOX_COLUMNS;
+    render_ctx.box_lines = box_lines > 0 ? box_lines : BOX_LINES;
+    render_ctx.all_pages = all_pages;
+    render_ctx.output_folder = output_folder;
+    if (load_font(font_folder, &render_ctx) != 0) {
+        return 1;
+    }
+
+    JobQueue queue = {0};
+    collect_archives(&queue, input_folder, "");
+    if (queue.job_count == 0) {
+        fprintf(stderr, "No BIN archives found in %s\n", input_folder);
+        return 1;
+    }
+    qsort(queue.jobs, queue.job_count, sizeof(ArchiveJob), compare_job);
+
+    //   带 ϱ    (ī̺긶 ϳ)
+    char path[1024];
+    for (size_t i = 0; i < queue.job_count; i++) {
+        snprintf(path, sizeof(path), "%s/%s/-", output_folder, queue.jobs[i].name);
+        make_parent_dirs(path);
+    }
+
+    if (thread_count <= 0) {
+        thread_count = get_cpu_count();
+    }
+    if ((size_t)thread_count > queue.job_count) {
+        thread_count = (int)queue.job_count;
+    }
+    queue.run = render_archive;
+    run_jobs(&queue, thread_count);
+
+    //  ī̺ ̸ ħ
+    StrBuf report = {0};
+    size_t message_count = 0, overflow_count = 0;
+    for (size_t i = 0; i < queue.job_count; i++) {
+        strbuf_append(&report, queue.jobs[i].text.data, queue.jobs[i].text.size);
+        message_count += queue.jobs[i].laid_out_count;
+        overflow_count += queue.jobs[i].overflow_count;
+    }
+    snprintf(path, sizeof(path), "%s/overflow.txt", output_folder);
+    int result = write_file(path, "wb", report.data ? report.data : "", report.size);
+    if (result == 0) {
+        printf("%zu archives, %zu messages, %zu overflowing (%dx%d): %s\n",
+               queue.job_count, message_count, overflow_count, render_ctx.box_columns, render_ctx.box_lines, path);
+    }
+
+    for (size_t i = 0; i < queue.job_count; i++) {
+        free(queue.jobs[i].path);
+        free(queue.jobs[i].name);
+        free(queue.jobs[i].text.data);
+    }
+    free(queue.jobs);
+    free(report.data);
+    free(render_ctx.atlas);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s d <input_file> <output_file> <offset_param> [<is_func>]\n", argv[0]);
+        fprintf(stderr, "       %s e <input_file> [<is_header>]\n", argv[0]);
+        fprintf(stderr, "       %s b <input_folder> <output_file> [<threads>]\n", argv[0]);
+        fprintf(stderr, "       %s r <font_folder> <input_folder> <output_folder> [<columns>] [<lines>] [<threads>] [<all_pages>]\n", argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "d") == 0) {
+        if (argc < 5 || argc > 6) {
+            fprintf(stderr, "Usage: %s d <input_file> <output_file> <offset_param> [<is_func>]\n", argv[0]);
+            return 1;
+        }
+
+        int is_func = argc > 5 ? atoi(argv[5]) : 0;
+        if (is_func < 0 || is_func >= 2) {
+            fprintf(stderr, "Invalid option\n");
+            return 1;
+        }
+        return decode_file(argv[2], argv[3], argv[4], is_func);
+    } else if (strcmp(argv[1], "e") == 0) {
+        if (argc > 4) {
+            fprintf(stderr, "Usage: %s e <input_file> [<is_header>]\n", argv[0]);
+            return 1;
+        }
+        return encode_file(argv[2], argc > 3 && atoi(argv[3]) == 1);
+    } else if (strcmp(argv[1], "b") == 0) {
+        if (argc < 4 || argc > 5) {
+            fprintf(stderr, "Usage: %s b <input_folder> <output_file> [<threads>]\n", argv[0]);
+            return 1;
+        }
+        return build_database(argv[2], argv[3], argc > 4 ? atoi(argv[4]) : 0);
+    } else if (strcmp(argv[1], "r") == 0) {
+        if (argc < 5 || argc > 9) {
+            fprintf(stderr, "Usage: %s r <font_folder> <input_folder> <output_folder> [<columns>] [<lines>] [<threads>] [<all_pages>]\n", argv[0]);
+            return 1;
+        }
+        return render_script(argv[2], argv[3], argv[4],
+                             argc > 5 ? atoi(argv[5]) : 0, argc > 6 ? atoi(argv[6]) : 0,
+                             argc > 7 ? atoi(argv[7]) : 0, argc > 8 && atoi(argv[8]) == 1);
+    } else {
+        fprintf(stderr, "Invalid command. Use 'd' to convert MSG to TXT, 'e' to convert TXT to MSG, 'b' to build a script database or 'r' to render text previews.\n");
+        return 1;
+    }
+}
+
+/*==============================================================*/
+/*	"MSGTool.c"	End of File										*/
+/*==============================================================*/
@@ -0,0 +1,559 @@
+/*******************************************************************************
+ *
+ *  Filename:  VRAMTool.c
+ *
+ *  Description:  This program renders every TIM, PIX, CLT and MTIM of a BIN
+ *  archive (or of its extracted folder) into one 1024x512 16bpp VRAM image
+ *  at the framebuffer positions recorded in the headers.
+ *
+ *  Author:  happy_land
+ *  Date:  2026-10-18
+ *  Last update:  --
+ *
+ *******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+//    忡 ÿ ϹǷ ڵ īʹ  
+#define MELT_STATS(...) do{ } while ( 0 )
+
+#include "compat.c"
+#include "stats.c"
+#include "melt.c"
+
+#define HEADER_SIZE         0x30
+#define CHUNK_SIZE          0x800
+#define PADDED_CLUT_SIZE    (CHUNK_SIZE - HEADER_SIZE)
+#define VRAM_WIDTH          1024
+#define VRAM_HEIGHT         512
+
+#define KIND_TIM            0x02    // TIM, PIX, CLT (  melt_find_variant())
+
+/*==============================================================*/
+/*	ؽó б													*/
+/*==============================================================*/
+typedef struct {
+    uint8_t *data;
+    size_t size;
+} ByteArray;
+
+// ׸ ϳ VRAM ġ 
+typedef struct {
+    uint8_t header[HEADER_SIZE];
+    const char *path;           //  Է   
+    const uint8_t *payload;     // ī̺ Է   ġ
+    size_t payload_size;
+    uint8_t *owned;             // Ͽ оų   
+    const uint8_t *clut;
+    size_t clut_size;
+    const uint8_t *pixels;
+    size_t pixel_size;
+    int failed;                 //   
+} Texture;
+
+typedef struct {
+    int x, y, width, height;
+} Rect;
+
+uint16_t read_u16(const uint8_t *data) {
+    return data[0] | (data[1] << 8);
+}
+
+uint32_t read_u32(const uint8_t *data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+void write_u16(uint8_t *data, uint16_t value) {
+    data[0] = value & 0xff;
+    data[1] = value >> 8;
+}
+
+void write_u32(uint8_t *data, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        data[i] = (value >> (i * 8)) & 0xff;
+    }
+}
+
+ByteArray read_file(const char *filename) {
+    ByteArray array = {NULL, 0};
+    FILE *file = NULL;
+    errno_t err = fopen_s(&file, filename, "rb");
+    if (err != 0 || file == NULL) {
+        fprintf(stderr, "Failed to open %s\n", filename);
+        return array;
+    }
+
+    fseek(file, 0, SEEK_END);
+    array.size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    array.data = (uint8_t *)malloc(array.size ? array.size : 1);
+    if (!array.data) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        exit(1);
+    }
+    fread(array.data, 1, array.size, file);
+    fclose(file);
+    return array;
+}
+
+//  ϵ ȷƮ ̹ VRAM ġ
+Rect clut_rect(const Texture *texture) {
+    Rect rect = { read_u16(texture->header + 0x0c), read_u16(texture->header + 0x0e),
+                  read_u16(texture->header + 0x10), read_u16(texture->header + 0x12) };
+    return rect;
+}
+
+Rect image_rect(const Texture *texture) {
+    Rect rect = { read_u16(texture->header + 0x14), read_u16(texture->header + 0x16),
+                  read_u16(texture->header + 0x18), read_u16(texture->header + 0x1a) };
+    return rect;
+}
+
+// ī̺ ׸  (CLUT 0x7d0 + ȼ) CLUT ȼ ġ ã
+void locate_entry_data(Texture *texture, const uint8_t *data, size_t size) {
+    Rect clut = clut_rect(texture);
+    Rect image = image_rect(texture);
+
+    if (image.width == 0) {  // CLT
+        texture->clut = data;
+        texture->clut_size = size;
+    } else if (size >= PADDED_CLUT_SIZE) {  // TIM, PIX
+        texture->clut = clut.width ? data : NULL;
+        texture->clut_size = clut.width ? PADDED_CLUT_SIZE : 0;
+        texture->pixels = data + PADDED_CLUT_SIZE;
+        texture->pixel_size = size - PADDED_CLUT_SIZE;
+    }
+}
+
+//  TIM  (TIM  + CLUT + ̹  + ȼ)
+void locate_tim_data(Texture *texture, const uint8_t *data, size_t size) {
+    if (size < 0x14 || read_u32(data) != 0x10) {
+        return;
+    }
+    size_t offset = 8;
+    if (read_u32(data + 4) & 8) {
+        uint32_t clut_length = read_u32(data + 8);
+        texture->clut = data + 0x14;
+        texture->clut_size = clut_length > 0x0c ? clut_length - 0x0c : 0;
+        offset += clut_length;
+    }
+    if (offset + 0x0c <= size) {
+        texture->pixels = data + offset + 0x0c;
+        texture->pixel_size = size - offset - 0x0c;
+    }
+}
+
+const char *file_extension(const char *path) {
+    const char *dot = strrchr(path, '.');
+    return dot ? dot + 1 : "";
+}
+
+// ׸ ϳ а (MTIM  ) CLUT ȼ ġ 
+void load_texture(Texture *texture) {
+    const uint8_t *data = texture->payload;
+    size_t size = texture->payload_size;
+
+    if (texture->path) {
+        ByteArray file = read_file(texture->path);
+        texture->owned = file.data;
+        data = file.data;
+        size = file.size;
+        if (!data) {
+            return;
+        }
+    }
+
+    if (melt_find_variant(texture->header)) {
+        if (read_u16(texture->header + 0x24) == 0) {
+            return;
+        }
+        char *decompressed = NULL;
+        unsigned int decompressed_size = decompress_data((const char *)data, size, (const char *)texture->header, &decompressed);
+        free(texture->owned);
+        texture->owned = (uint8_t *)decompressed;
+        if (decompressed_size == 0) {
+            // ߷Ȱų ջ MTIM ׸ 
+            fprintf(stderr, "Skipping %s\n", texture->path ? texture->path : "a corrupt MTIM entry");
+            texture->failed = 1;
+            return;
+        }
+
+        // ȷƮ Բ   (CLUT 0x7d0 + ȼ)
+        Rect image = image_rect(texture);
+        size_t image_size = (size_t)image.width * image.height * 2;
+        if (clut_rect(texture).width && decompressed_size >= PADDED_CLUT_SIZE + image_size) {
+            locate_entry_data(texture, texture->owned, decompressed_size);
+        } else {
+            texture->pixels = texture->owned;
+            texture->pixel_size = decompressed_size;
+        }
+    } else if (texture->path && strcmp(file_extension(texture->path), "TIM") == 0) {
+        locate_tim_data(texture, data, size);
+    } else if (texture->path) {
+        //  PIX CLT պκ (CLUT 0x7d0) 
+        if (image_rect(texture).width == 0) {
+            texture->clut = data;
+            texture->clut_size = size;
+        } else {
+            texture->pixels = data;
+            texture->pixel_size = size;
+        }
+    } else {
+        locate_entry_data(texture, data, size);
+    }
+}
+
+typedef struct {
+    Texture *items;
+    size_t count;
+    size_t capacity;
+} TextureList;
+
+Texture *add_texture(TextureList *list, const uint8_t *header) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->items = (Texture *)realloc(list->items, list->capacity * sizeof(Texture));
+        if (!list->items) {
+            fprintf(stderr, "Failed to allocate memory\n");
+            exit(1);
+        }
+    }
+    Texture *texture = &list->items[list->count++];
+    memset(texture, 0, sizeof(Texture));
+    memcpy(texture->header, header, HEADER_SIZE);
+    return texture;
+}
+
+int is_texture_kind(const uint8_t *header) {
+    uint32_t kind = read_u32(header);
+    return kind == KIND_TIM || melt_find_variant(header) != NULL;
+}
+
+// BIN ī̺ ׸  ߰
+void collect_archive(TextureList *list, const ByteArray *archive) {
+    size_t offset = 0;
+    while (offset + HEADER_SIZE <= archive->size) {
+        const uint8_t *header = archive->data + offset;
+        size_t padded_size = (size_t)read_u32(header + 0x08) * CHUNK_SIZE;
+        if (padded_size == 0 || offset + padded_size > archive->size) {
+            break;
+        }
+        if (is_texture_kind(header)) {
+            Texture *texture = add_texture(list, header);
+            texture->payload = header + HEADER_SIZE;
+            texture->payload_size = padded_size - HEADER_SIZE;
+        }
+        offset += padded_size;
+    }
+}
+
+//  : HEADER.BIN  NNNN_*.*  ã
+//  Ȯڰ ׸  ´ (MELT  MTIM, 0x02 TIM/PIX/CLT)
+// MELTTIMTool d MTIM   PIX  ͷ  ʵ 
+int extension_matches_kind(const uint8_t *header, const char *name) {
+    const char *extension = file_extension(name);
+    if (melt_find_variant(header)) {
+        return strcmp(extension, "MTIM") == 0;
+    }
+    if (read_u32(header) == KIND_TIM) {
+        return strcmp(extension, "TIM") == 0 || strcmp(extension, "PIX") == 0 || strcmp(extension, "CLT") == 0;
+    }
+    return 0;
+}
+
+int collect_folder(TextureList *list, const char *folder, ByteArray *headers, char ***paths) {
+    char header_path[1024];
+    snprintf(header_path, sizeof(header_path), "%s/HEADER.BIN", folder);
+    *headers = read_file(header_path);
+    if (!headers->data) {
+        return 1;
+    }
+
+    size_t count = headers->size / HEADER_SIZE;
+    *paths = (char **)calloc(count ? count : 1, sizeof(char *));
+
+    DIR *dir = opendir(folder);
+    if (!dir) {
+        fprintf(stderr, "Failed to open %s\n", folder);
+        return 1;
+    }
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        const char *name = ent->d_name;
+        if (strlen(name) < 5 || name[4] != '_') {
+            continue;
+        }
+        int index = 0;
+        for (int i = 0; i < 4; i++) {
+            if (name[i] < '0' || name[i] > '9') {
+                index = -1;
+                break;
+            }
+            index = index * 10 + (name[i] - '0');
+        }
+        if (index < 0 || (size_t)index >= count || !extension_matches_kind(headers->data + (size_t)index * HEADER_SIZE, name)) {
+            continue;
+        }
+        size_t length = strlen(folder) + strlen(name) + 2;
+        char *path = (char *)malloc(length);
+        snprintf(path, length, "%s/%s", folder, name);
+        if ((*paths)[index]) {
+            // combbin -có ȣ  ϳ 
+            fprintf(stderr, "Duplicate files for entry %d: %s and %s\n", index, (*paths)[index], path);
+            free(path);
+            closedir(dir);
+            return 1;
+        }
+        (*paths)[index] = path;
+    }
+    closedir(dir);
+
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *header = headers->data + i * HEADER_SIZE;
+        if ((*paths)[i] && is_texture_kind(header)) {
+            add_texture(list, header)->path = (*paths)[i];
+        }
+    }
+    return 0;
+}
+
+/*==============================================================*/
+/*	VRAM ռ													*/
+/*==============================================================*/
+// 帶 VRAM   ϳ  (쳢 ġ Ƿ  ʿ )
+typedef struct {
+    TextureList *list;
+    uint16_t *vram;
+    int y_start, y_end;
+    size_t next;                //   ܰ迡  ׸ ȣ
+    pthread_mutex_t *lock;
+} Worker;
+
+//  (width x height) 簢 VRAM rect ġ  ( ʸ)
+void blit(uint16_t *vram, Rect rect, const uint8_t *data, size_t size, int y_start, int y_end) {
+    if (!data || rect.width <= 0 || rect.height <= 0 || rect.x >= VRAM_WIDTH) {
+        return;
+    }
+    int width = rect.x + rect.width > VRAM_WIDTH ? VRAM_WIDTH - rect.x : rect.width;
+    int top = rect.y > y_start ? rect.y : y_start;
+    int bottom = rect.y + rect.height < y_end ? rect.y + rect.height : y_end;
+
+    for (int y = top; y < bottom; y++) {
+        size_t source = (size_t)(y - rect.y) * rect.width * 2;
+        if (source + (size_t)width * 2 > size) {
+            break;
+        }
+        uint16_t *row = vram + (size_t)y * VRAM_WIDTH + rect.x;
+        for (int x = 0; x < width; x++) {
+            row[x] = read_u16(data + source + x * 2);
+        }
+    }
+}
+
+void *load_worker(void *arg) {
+    Worker *worker = (Worker *)arg;
+    for (;;) {
+        pthread_mutex_lock(worker->lock);
+        size_t index = worker->next++;
+        pthread_mutex_unlock(worker->lock);
+
+        if (index >= worker->list->count) {
+            break;
+        }
+        load_texture(&worker->list->items[index]);
+    }
+    return NULL;
+}
+
+//  ׸  ׸  ׸  ׸
+void *render_worker(void *arg) {
+    Worker *worker = (Worker *)arg;
+    for (size_t i = 0; i < worker->list->count; i++) {
+        Texture *texture = &worker->list->items[i];
+        blit(worker->vram, image_rect(texture), texture->pixels, texture->pixel_size, worker->y_start, worker->y_end);
+        blit(worker->vram, clut_rect(texture), texture->clut, texture->clut_size, worker->y_start, worker->y_end);
+    }
+    return NULL;
+}
+
+int get_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+void render_vram(TextureList *list, uint16_t *vram, int thread_count) {
+    pthread_mutex_t lock;
+    pthread_mutex_init(&lock, NULL);
+    pthread_t *threads = (pthread_t *)malloc(thread_count * sizeof(pthread_t));
+    Worker *workers = (Worker *)calloc(thread_count, sizeof(Worker));
+    Worker loader = { list, vram, 0, 0, 0, &lock };
+
+    // 1ܰ: б MTIM   (  尡  ׸ )
+    stats_begin(PHASE_READ);
+    for (int i = 0; i < thread_count; i++) {
+        pthread_create(&threads[i], NULL, load_worker, &loader);
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    stats_end(PHASE_READ);
+
+    // 2ܰ: VRAM    ׸
+    stats_begin(PHASE_PROCESS);
+    for (int i = 0; i < thread_count; i++) {
+        workers[i].list = list;
+        workers[i].vram = vram;
+        workers[i].y_start = VRAM_HEIGHT * i / thread_count;
+        workers[i].y_end = VRAM_HEIGHT * (i + 1) / thread_count;
+        pthread_create(&threads[i], NULL, render_worker, &workers[i]);
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    stats_end(PHASE_PROCESS);
+
+    free(workers);
+    free(threads);
+    pthread_mutex_destroy(&lock);
+}
+
+// 16bpp TIM  (tim2bmp   )
+int write_vram_tim(const char *filename, const uint16_t *vram) {
+    size_t pixel_size = (size_t)VRAM_WIDTH * VRAM_HEIGHT * 2;
+    uint8_t header[0x14];
+    write_u32(header + 0x00, 0x10);                 // TIM
+    write_u32(header + 0x04, 0x02);                 // 16bpp, CLUT 
+    write_u32(header + 0x08, 0x0c + pixel_size);
+    write_u16(header + 0x0c, 0);
+    write_u16(header + 0x0e, 0);
+    write_u16(header + 0x10, VRAM_WIDTH);
+    write_u16(header + 0x12, VRAM_HEIGHT);
+
+    uint8_t *pixels = (uint8_t *)malloc(pixel_size);
+    if (!pixels) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < (size_t)VRAM_WIDTH * VRAM_HEIGHT; i++) {
+        write_u16(pixels + i * 2, vram[i]);
+    }
+
+    FILE *file = NULL;
+    errno_t err = fopen_s(&file, filename, "wb");
+    if (err != 0 || file == NULL) {
+        perror("Unable to open a file");
+        free(pixels);
+        return 1;
+    }
+    fwrite(header, 1, sizeof(header), file);
+    fwrite(pixels, 1, pixel_size, file);
+    fclose(file);
+    free(pixels);
+
+    stats.bytes_written += sizeof(header) + pixel_size;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    stats_parse_args(&argc, argv, "VRAMTool");
+    stats.input = argc > 1 ? argv[1] : "";
+    stats.command = "render";
+
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "Usage: %s <input_archive|input_folder> <output_tim> [<threads>] [--stats[=json]]\n", argv[0]);
+        return 1;
+    }
+
+    int thread_count = argc > 3 ? atoi(argv[3]) : 0;
+    if (thread_count <= 0) {
+        thread_count = get_cpu_count();
+    }
+    if (thread_count > VRAM_HEIGHT) {
+        thread_count = VRAM_HEIGHT;
+    }
+
+    TextureList list = {0};
+    ByteArray archive = {NULL, 0};
+    ByteArray headers = {NULL, 0};
+    char **paths = NULL;
+
+    struct stat st;
+    if (stat(argv[1], &st) != 0) {
+        fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return 1;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        if (collect_folder(&list, argv[1], &headers, &paths) != 0) {
+            return 1;
+        }
+    } else {
+        archive = read_file(argv[1]);
+        if (!archive.data) {
+            return 1;
+        }
+        stats.bytes_read += archive.size;
+        collect_archive(&list, &archive);
+    }
+
+    uint16_t *vram = (uint16_t *)calloc((size_t)VRAM_WIDTH * VRAM_HEIGHT, sizeof(uint16_t));
+    if (!vram) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        return 1;
+    }
+    render_vram(&list, vram, thread_count);
+
+    stats_begin(PHASE_WRITE);
+    int result = write_vram_tim(argv[2], vram);
+    stats_end(PHASE_WRITE);
+    size_t failed = 0;
+    for (size_t i = 0; i < list.count; i++) {
+        failed += list.items[i].failed;
+    }
+    if (result == 0) {
+        printf("%zu textures: %s\n", list.count - failed, argv[2]);
+    }
+    if (failed) {
+        fprintf(stderr, "%zu textures could not be decompressed\n", failed);
+        result = 1;
+    }
+
+    for (size_t i = 0; i < list.count; i++) {
+        free(list.items[i].owned);
+    }
+    if (paths) {
+        for (size_t i = 0; i < headers.size / HEADER_SIZE; i++) {
+            free(paths[i]);
+        }
+        free(paths);
+    }
+    free(list.items);
+    free(headers.data);
+    free(archive.data);
+    free(vram);
+
+    stats_report();
+    return result;
+}
+
+/*==============================================================*/
+/*	"VRAMTool.c"	End of File										*/
+/*==============================================================*/
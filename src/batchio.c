@@ -0,0 +1,777 @@
+/*******************************************************************************
+ *
+ *  Filename:  batchio.c
+ *
+ *  Description:  Batch file I/O for tools that process many small files:
+ *  reads are kept in flight with io_uring (Linux, no liburing needed) into
+ *  a pool of reused, registered buffers while worker threads run the codec,
+ *  and finished outputs are written back through the same ring. Without
+ *  io_uring (other systems, old kernels, or --io=threads) every worker
+ *  thread reads and writes its own files with stdio. Included directly by
+ *  each tool, like compat.c, after compat.c.
+ *
+ *  Author:  happy_land
+ *  Date:  2026-10-18
+ *  Last update:  --
+ *
+ *******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__linux__) && !defined(BATCHIO_NO_URING) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define BATCHIO_URING 1
+#endif
+#endif
+
+#ifdef BATCHIO_URING
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif
+
+#define BATCHIO_DEPTH           32          // ÿ д   ( )
+#define BATCHIO_BUFFER_SIZE     0x40000     //  ϳ ũ,  ū   Ҵ
+
+enum { BATCHIO_AUTO, BATCHIO_THREADS };
+
+int batchio_mode = BATCHIO_AUTO;
+
+//   ϳ (data process()   Ͽ )
+typedef struct {
+    const char *path;
+    size_t index;               // paths ȣ
+    uint8_t *data;
+    size_t size;
+} IoFile;
+
+typedef struct BatchIo BatchIo;
+typedef void (*BatchIoProcess)(BatchIo *io, const IoFile *file, void *arg);
+
+//  ⿭ ׸
+typedef struct IoWrite {
+    char *path;
+    uint8_t *data;
+    size_t size;
+    size_t done;
+    int fd;
+    struct IoWrite *next;
+} IoWrite;
+
+//  а ְų ۾ 尡 ó  
+typedef struct IoSlot {
+    IoFile file;
+    uint8_t *buffer;            // ϵ  (BATCHIO_BUFFER_SIZE)
+    int buffer_index;
+    uint8_t *large;             // ۺ ū 
+    size_t done;
+    int fd;
+    struct IoSlot *next;
+} IoSlot;
+
+struct BatchIo {
+    const char **paths;
+    size_t count;
+    size_t next;                //    ȣ
+    int threads;
+    BatchIoProcess process;
+    void *arg;
+    int uring;                  // 1̸ io_uring, 0̸ 帶 stdio
+
+    pthread_mutex_t lock;
+    pthread_cond_t ready_cond;
+    IoSlot *ready;              // бⰡ  ó ٸ 
+    IoSlot *ready_tail;
+    IoSlot *released;           // ó  ٽ   ִ 
+    IoWrite *writes;            //  ѱ 
+    size_t processing;          // ready    released ƿ   
+    int finished;
+    int event_fd;
+
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    size_t failed;
+};
+
+/*==============================================================*/
+/*	 鿣 (stdio)										*/
+/*==============================================================*/
+// ۾ 帶  ϳ  
+void *batchio_thread_worker(void *arg) {
+    BatchIo *io = (BatchIo *)arg;
+    uint8_t *buffer = NULL;
+    size_t capacity = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&io->lock);
+        size_t index = io->next++;
+        pthread_mutex_unlock(&io->lock);
+        if (index >= io->count) {
+            break;
+        }
+
+        FILE *file = NULL;
+        errno_t err = fopen_s(&file, io->paths[index], "rb");
+        if (err != 0 || file == NULL) {
+            fprintf(stderr, "Failed to open %s\n", io->paths[index]);
+            pthread_mutex_lock(&io->lock);
+            io->failed++;
+            pthread_mutex_unlock(&io->lock);
+            continue;
+        }
+        fseek(file, 0, SEEK_END);
+        size_t size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        if (size > capacity) {
+            free(buffer);
+            capacity = size > BATCHIO_BUFFER_SIZE ? size : BATCHIO_BUFFER_SIZE;
+            buffer = (uint8_t *)malloc(capacity);
+            if (!buffer) {
+                fprintf(stderr, "Failed to allocate memory\n");
+                exit(1);
+            }
+        }
+        size = fread(buffer, 1, size, file);
+        fclose(file);
+
+        pthread_mutex_lock(&io->lock);
+        io->bytes_read += size;
+        pthread_mutex_unlock(&io->lock);
+
+        IoFile item = { io->paths[index], index, buffer, size };
+        io->process(io, &item, io->arg);
+    }
+    free(buffer);
+    return NULL;
+}
+
+int batchio_write_now(BatchIo *io, const char *path, const uint8_t *data, size_t size) {
+    FILE *file = NULL;
+    errno_t err = fopen_s(&file, path, "wb");
+    if (err != 0 || file == NULL) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return 1;
+    }
+    size_t written = fwrite(data, 1, size, file);
+    fclose(file);
+
+    pthread_mutex_lock(&io->lock);
+    io->bytes_written += written;
+    if (written != size) {
+        io->failed++;
+    }
+    pthread_mutex_unlock(&io->lock);
+    return written == size ? 0 : 1;
+}
+
+/*==============================================================*/
+/*	io_uring 鿣												*/
+/*==============================================================*/
+#ifdef BATCHIO_URING
+#define BATCHIO_EVENT_TAG       ((uint64_t)-1)
+#define BATCHIO_WRITE_FLAG      ((uint64_t)1)   // user_data  Ʈ (ʹ ¦)
+
+typedef struct {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+    unsigned entries;
+    unsigned tail;              //  Ŀο ˸  SQ 
+    unsigned submitted;
+    int fixed_buffers;          //  Ͽ  READ_FIXED 
+} Ring;
+
+int ring_init(Ring *ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(ring, 0, sizeof(Ring));
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
+        return -1;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        close(ring->fd);
+        return -1;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            munmap(ring->sq_ring, ring->sq_ring_size);
+            close(ring->fd);
+            return -1;
+        }
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe *)mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (ring->cq_ring != ring->sq_ring) {
+            munmap(ring->cq_ring, ring->cq_ring_size);
+        }
+        munmap(ring->sq_ring, ring->sq_ring_size);
+        close(ring->fd);
+        return -1;
+    }
+
+    uint8_t *sq = (uint8_t *)ring->sq_ring;
+    uint8_t *cq = (uint8_t *)ring->cq_ring;
+    ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    ring->entries = params.sq_entries;
+    ring->tail = *ring->sq_tail;
+    ring->submitted = ring->tail;
+    return 0;
+}
+
+// ϴ  Ŀ  ϴ Ȯ
+// IORING_OP_READ/WRITE 5.6 Ƿ PROBE  Ŀ (5.1~5.5) ׻ 0
+int ring_probe(Ring *ring) {
+    static const int opcodes[] = { IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED };
+    const unsigned op_count = 256;
+    struct io_uring_probe *probe = (struct io_uring_probe *)calloc(1, sizeof(struct io_uring_probe) + op_count * sizeof(struct io_uring_probe_op));
+    if (!probe) {
+        return 0;
+    }
+    int supported = syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, probe, op_count) == 0;
+    for (size_t i = 0; supported && i < sizeof(opcodes) / sizeof(opcodes[0]); i++) {
+        supported = opcodes[i] <= probe->last_op && (probe->ops[opcodes[i]].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    return supported;
+}
+
+void ring_free(Ring *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+}
+
+//  SQE ϳ  (   )
+struct io_uring_sqe *ring_get_sqe(Ring *ring) {
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->tail - head >= ring->entries) {
+        return NULL;
+    }
+    unsigned index = ring->tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[index] = index;
+    ring->tail++;
+    return sqe;
+}
+
+//  SQE ϰ wait 1̸ Ϸᰡ ϳ ̻   ٸ
+int ring_submit(Ring *ring, int wait) {
+    __atomic_store_n(ring->sq_tail, ring->tail, __ATOMIC_RELEASE);
+    unsigned count = ring->tail - ring->submitted;
+    for (;;) {
+        int result = (int)syscall(__NR_io_uring_enter, ring->fd, count, wait ? 1 : 0,
+                                  wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (result >= 0) {
+            ring->submitted += (unsigned)result;
+            return 0;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+void ring_prepare(struct io_uring_sqe *sqe, int opcode, int fd, void *buffer, size_t size, uint64_t offset, uint64_t user_data) {
+    sqe->opcode = (uint8_t)opcode;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buffer;
+    sqe->len = (uint32_t)size;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+}
+
+struct io_uring_sqe *batchio_sqe(Ring *ring) {
+    struct io_uring_sqe *sqe = ring_get_sqe(ring);
+    while (!sqe) {
+        ring_submit(ring, 0);
+        sqe = ring_get_sqe(ring);
+    }
+    return sqe;
+}
+
+void batchio_submit_read(Ring *ring, IoSlot *slot) {
+    uint8_t *target = (slot->large ? slot->large : slot->buffer) + slot->done;
+    size_t remaining = slot->file.size - slot->done;
+    struct io_uring_sqe *sqe = batchio_sqe(ring);
+    if (!slot->large && ring->fixed_buffers) {
+        ring_prepare(sqe, IORING_OP_READ_FIXED, slot->fd, target, remaining, slot->done, (uint64_t)(uintptr_t)slot);
+        sqe->buf_index = (uint16_t)slot->buffer_index;
+    } else {
+        ring_prepare(sqe, IORING_OP_READ, slot->fd, target, remaining, slot->done, (uint64_t)(uintptr_t)slot);
+    }
+}
+
+void batchio_submit_write(Ring *ring, IoWrite *output) {
+    struct io_uring_sqe *sqe = batchio_sqe(ring);
+    ring_prepare(sqe, IORING_OP_WRITE, output->fd, output->data + output->done, output->size - output->done,
+                 output->done, (uint64_t)(uintptr_t)output | BATCHIO_WRITE_FLAG);
+}
+
+void batchio_free_write(IoWrite *output) {
+    free(output->path);
+    free(output->data);
+    free(output);
+}
+
+void batchio_wake(BatchIo *io) {
+    uint64_t one = 1;
+    if (write(io->event_fd, &one, sizeof(one)) < 0) {
+        // ̹   
+    }
+}
+
+// бⰡ   ۾ 忡 ѱ
+void batchio_push_ready(BatchIo *io, IoSlot *slot) {
+    close(slot->fd);
+    slot->file.data = slot->large ? slot->large : slot->buffer;
+    slot->file.size = slot->done;
+    slot->next = NULL;
+
+    pthread_mutex_lock(&io->lock);
+    if (io->ready_tail) {
+        io->ready_tail->next = slot;
+    } else {
+        io->ready = slot;
+    }
+    io->ready_tail = slot;
+    io->processing++;
+    io->bytes_read += slot->done;
+    pthread_cond_signal(&io->ready_cond);
+    pthread_mutex_unlock(&io->lock);
+}
+
+void *batchio_uring_worker(void *arg) {
+    BatchIo *io = (BatchIo *)arg;
+    for (;;) {
+        pthread_mutex_lock(&io->lock);
+        while (!io->ready && !io->finished) {
+            pthread_cond_wait(&io->ready_cond, &io->lock);
+        }
+        IoSlot *slot = io->ready;
+        if (!slot) {
+            pthread_mutex_unlock(&io->lock);
+            break;
+        }
+        io->ready = slot->next;
+        if (!io->ready) {
+            io->ready_tail = NULL;
+        }
+        pthread_mutex_unlock(&io->lock);
+
+        io->process(io, &slot->file, io->arg);
+
+        // ۸ ְ I/O 带 
+        pthread_mutex_lock(&io->lock);
+        free(slot->large);
+        slot->large = NULL;
+        slot->next = io->released;
+        io->released = slot;
+        io->processing--;
+        pthread_mutex_unlock(&io->lock);
+        batchio_wake(io);
+    }
+    return NULL;
+}
+
+//    slot б  (    ǳʶ).    0
+int batchio_start_read(BatchIo *io, Ring *ring, IoSlot *slot) {
+    while (io->next < io->count) {
+        size_t index = io->next++;
+        const char *path = io->paths[index];
+        int fd = open(path, O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            fprintf(stderr, "Failed to open %s\n", path);
+            if (fd >= 0) {
+                close(fd);
+            }
+            io->failed++;
+            continue;
+        }
+
+        slot->file.path = path;
+        slot->file.index = index;
+        slot->file.size = (size_t)st.st_size;
+        slot->done = 0;
+        slot->fd = fd;
+        slot->large = NULL;
+        if (slot->file.size > BATCHIO_BUFFER_SIZE) {
+            slot->large = (uint8_t *)malloc(slot->file.size);
+            if (!slot->large) {
+                fprintf(stderr, "Failed to allocate memory\n");
+                exit(1);
+            }
+        }
+        if (slot->file.size == 0) {
+            batchio_push_ready(io, slot);
+            return 1;
+        }
+        batchio_submit_read(ring, slot);
+        return 1;
+    }
+    return 0;
+}
+
+//    ų ʿ   -1 (ƹ͵ б ),    1
+int batchio_run_uring(BatchIo *io) {
+    Ring ring;
+    if (ring_init(&ring, BATCHIO_DEPTH * 2 + 2) != 0) {
+        return -1;
+    }
+    if (!ring_probe(&ring)) {
+        ring_free(&ring);
+        return -1;
+    }
+    io->event_fd = eventfd(0, EFD_CLOEXEC);
+    if (io->event_fd < 0) {
+        ring_free(&ring);
+        return -1;
+    }
+
+    // ۴   Ҵؼ ϰ ϸ 
+    uint8_t *buffers = (uint8_t *)malloc((size_t)BATCHIO_DEPTH * BATCHIO_BUFFER_SIZE);
+    IoSlot *slots = (IoSlot *)calloc(BATCHIO_DEPTH, sizeof(IoSlot));
+    struct iovec iovecs[BATCHIO_DEPTH];
+    if (!buffers || !slots) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        exit(1);
+    }
+    for (int i = 0; i < BATCHIO_DEPTH; i++) {
+        slots[i].buffer = buffers + (size_t)i * BATCHIO_BUFFER_SIZE;
+        slots[i].buffer_index = i;
+        iovecs[i].iov_base = slots[i].buffer;
+        iovecs[i].iov_len = BATCHIO_BUFFER_SIZE;
+    }
+    // Ͽ ϸ (RLIMIT_MEMLOCK ) Ϲ READ  ۸ 
+    ring.fixed_buffers = syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS, iovecs, BATCHIO_DEPTH) == 0;
+
+    pthread_t *threads = (pthread_t *)malloc(io->threads * sizeof(pthread_t));
+    for (int i = 0; i < io->threads; i++) {
+        pthread_create(&threads[i], NULL, batchio_uring_worker, io);
+    }
+
+    // ó BATCHIO_DEPTH б ϰ, eventfd б ۾  ȣ 
+    IoSlot *free_slots = NULL;
+    for (int i = BATCHIO_DEPTH - 1; i >= 0; i--) {
+        slots[i].next = free_slots;
+        free_slots = &slots[i];
+    }
+    uint64_t event_value;
+    ring_prepare(batchio_sqe(&ring), IORING_OP_READ, io->event_fd, &event_value, sizeof(event_value), 0, BATCHIO_EVENT_TAG);
+    int event_armed = 1;
+
+    IoWrite *queued = NULL, *queued_tail = NULL;
+    size_t reads_in_flight = 0, writes_in_flight = 0;
+    int result = 0;
+    for (;;) {
+        pthread_mutex_lock(&io->lock);
+        while (io->released) {
+            IoSlot *slot = io->released;
+            io->released = slot->next;
+            slot->next = free_slots;
+            free_slots = slot;
+        }
+        //  ⸦ ⿭   (۾  տ Ƿ )
+        IoWrite *new_writes = NULL;
+        while (io->writes) {
+            IoWrite *output = io->writes;
+            io->writes = output->next;
+            output->next = new_writes;
+            new_writes = output;
+        }
+        size_t processing = io->processing;
+        pthread_mutex_unlock(&io->lock);
+
+        while (free_slots && io->next < io->count) {
+            IoSlot *slot = free_slots;
+            free_slots = slot->next;
+            if (!batchio_start_read(io, &ring, slot)) {
+                slot->next = free_slots;
+                free_slots = slot;
+                break;
+            }
+            if (slot->file.size) {
+                reads_in_flight++;
+            } else {
+                processing++;
+            }
+        }
+
+        if (new_writes) {
+            if (queued_tail) {
+                queued_tail->next = new_writes;
+            } else {
+                queued = new_writes;
+            }
+            for (queued_tail = new_writes; queued_tail->next; queued_tail = queued_tail->next) {
+            }
+        }
+
+        // CQ ġ ʵ ⵵ BATCHIO_DEPTH ÿ
+        while (queued && writes_in_flight < BATCHIO_DEPTH) {
+            IoWrite *output = queued;
+            queued = output->next;
+            if (!queued) {
+                queued_tail = NULL;
+            }
+            output->fd = open(output->path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (output->fd < 0) {
+                fprintf(stderr, "Failed to open %s\n", output->path);
+                io->failed++;
+                batchio_free_write(output);
+                continue;
+            }
+            if (output->size == 0) {
+                close(output->fd);
+                batchio_free_write(output);
+                continue;
+            }
+            batchio_submit_write(&ring, output);
+            writes_in_flight++;
+        }
+
+        if (io->next >= io->count && reads_in_flight == 0 && writes_in_flight == 0 && !queued && processing == 0) {
+            //  Ȯ:  ̿ ۾ 尡 ⸦ ־  
+            pthread_mutex_lock(&io->lock);
+            int idle = io->processing == 0 && io->writes == NULL;
+            pthread_mutex_unlock(&io->lock);
+            if (idle) {
+                break;
+            }
+        }
+
+        // eventfd бⰡ   ȣ      I/O    ٸ
+        if (!event_armed && reads_in_flight == 0 && writes_in_flight == 0) {
+            if (read(io->event_fd, &event_value, sizeof(event_value)) < 0 && errno != EINTR) {
+                perror("eventfd");
+                result = 1;
+                break;
+            }
+            continue;
+        }
+
+        if (ring_submit(&ring, 1) != 0) {
+            perror("io_uring_enter");
+            result = 1;
+            break;
+        }
+
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+            uint64_t user_data = cqe->user_data;
+            int res = cqe->res;
+
+            if (user_data == BATCHIO_EVENT_TAG) {
+                //  б⸦ ٽ ɸ   ٷ ƿ   ǹǷ ׸
+                if (res < 0) {
+                    fprintf(stderr, "Failed to read the eventfd: %s\n", strerror(-res));
+                    event_armed = 0;
+                } else {
+                    ring_prepare(batchio_sqe(&ring), IORING_OP_READ, io->event_fd, &event_value, sizeof(event_value), 0, BATCHIO_EVENT_TAG);
+                }
+            } else if (user_data & BATCHIO_WRITE_FLAG) {
+                IoWrite *output = (IoWrite *)(uintptr_t)(user_data & ~BATCHIO_WRITE_FLAG);
+                if (res > 0) {
+                    output->done += (size_t)res;
+                    io->bytes_written += (uint64_t)res;
+                }
+                if (res > 0 && output->done < output->size) {
+                    batchio_submit_write(&ring, output);  // Ϻθ   
+                    continue;
+                }
+                if (res <= 0) {
+                    fprintf(stderr, "Failed to write %s: %s\n", output->path, strerror(res < 0 ? -res : EIO));
+                    io->failed++;
+                }
+                close(output->fd);
+                batchio_free_write(output);
+                writes_in_flight--;
+            } else {
+                IoSlot *slot = (IoSlot *)(uintptr_t)user_data;
+                if (res > 0) {
+                    slot->done += (size_t)res;
+                }
+                if (res > 0 && slot->done < slot->file.size) {
+                    batchio_submit_read(&ring, slot);
+                    continue;
+                }
+                reads_in_flight--;
+                if (res < 0) {
+                    fprintf(stderr, "Failed to read %s: %s\n", slot->file.path, strerror(-res));
+                    io->failed++;
+                    close(slot->fd);
+                    free(slot->large);
+                    slot->large = NULL;
+                    slot->next = free_slots;
+                    free_slots = slot;
+                    continue;
+                }
+                batchio_push_ready(io, slot);  // res == 0̸   ̿ پ 
+            }
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_lock(&io->lock);
+    io->finished = 1;
+    pthread_cond_broadcast(&io->ready_cond);
+    pthread_mutex_unlock(&io->lock);
+    for (int i = 0; i < io->threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    //    eventfd б⵵ ҵ
+    ring_free(&ring);
+    close(io->event_fd);
+    free(threads);
+    free(slots);
+    free(buffers);
+    return result;
+}
+#endif
+
+/*==============================================================*/
+/*															*/
+/*==============================================================*/
+// --io=threads ɼ ã  Ͽ  (io_uring  )
+void batchio_parse_args(int *argc, char *argv[]) {
+    int count = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--io=threads") == 0) {
+            batchio_mode = BATCHIO_THREADS;
+        } else if (strcmp(argv[i], "--io=auto") == 0) {
+            batchio_mode = BATCHIO_AUTO;
+        } else if (strncmp(argv[i], "--io=", 5) == 0) {
+            fprintf(stderr, "Invalid I/O backend: %s (use --io=auto or --io=threads)\n", argv[i] + 5);
+            exit(1);
+        } else {
+            argv[count++] = argv[i];
+        }
+    }
+    *argc = count;
+    argv[count] = NULL;
+}
+
+// process() ȣ:  path  (data malloc ,  ѱ)
+int batchio_write(BatchIo *io, const char *path, uint8_t *data, size_t size) {
+    if (!io->uring) {
+        int result = batchio_write_now(io, path, data, size);
+        free(data);
+        return result;
+    }
+
+    IoWrite *output = (IoWrite *)calloc(1, sizeof(IoWrite));
+    size_t length = strlen(path) + 1;
+    char *copy = (char *)malloc(length);
+    if (!output || !copy) {
+        fprintf(stderr, "Failed to allocate memory\n");
+        exit(1);
+    }
+    memcpy(copy, path, length);
+    output->path = copy;
+    output->data = data;
+    output->size = size;
+    output->fd = -1;
+
+    pthread_mutex_lock(&io->lock);
+    output->next = io->writes;
+    io->writes = output;
+    pthread_mutex_unlock(&io->lock);
+#ifdef BATCHIO_URING
+    batchio_wake(io);
+#endif
+    return 0;
+}
+
+// paths   о ۾ 忡 process() θ (  )
+//    ȯ
+size_t batchio_run(const char **paths, size_t count, int threads, BatchIoProcess process, void *arg,
+                   const char **backend, uint64_t *bytes_read, uint64_t *bytes_written) {
+    BatchIo io;
+    memset(&io, 0, sizeof(io));
+    io.paths = paths;
+    io.count = count;
+    io.threads = threads > 0 ? threads : 1;
+    io.process = process;
+    io.arg = arg;
+    pthread_mutex_init(&io.lock, NULL);
+    pthread_cond_init(&io.ready_cond, NULL);
+
+    int done = 0;
+#ifdef BATCHIO_URING
+    if (batchio_mode == BATCHIO_AUTO) {
+        io.uring = 1;
+        int result = batchio_run_uring(&io);
+        if (result >= 0) {
+            done = 1;
+            io.failed += result;
+            *backend = "io_uring";
+        } else {
+            io.uring = 0;  // Ŀ io_uring Ұų (seccomp, io_uring_disabled) READ/WRITE  
+        }
+    }
+#endif
+    if (!done) {
+        *backend = "threads";
+        pthread_t *workers = (pthread_t *)malloc(io.threads * sizeof(pthread_t));
+        for (int i = 0; i < io.threads; i++) {
+            pthread_create(&workers[i], NULL, batchio_thread_worker, &io);
+        }
+        for (int i = 0; i < io.threads; i++) {
+            pthread_join(workers[i], NULL);
+        }
+        free(workers);
+    }
+
+    pthread_cond_destroy(&io.ready_cond);
+    pthread_mutex_destroy(&io.lock);
+    *bytes_read = io.bytes_read;
+    *bytes_written = io.bytes_written;
+    return io.failed;
+}
+
+/*==============================================================*/
+/*	"batchio.c"	End of File										*/
+/*==============================================================*/
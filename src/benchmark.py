@@ -0,0 +1,367 @@
+# -*- coding: cp949 -*-
+"""
+benchmark.py
+
+Description: Script to benchmark the whole repack pipeline on synthetic archives.
+Author: happy_land
+Date: 26-10-18
+Last update: --
+
+Functionality:
+- Generate BIN archives with TIM, CLT, PIX, MTIM, MSG and DAT entries, so no game data is needed.
+- Run extract -> decompress -> decode -> edit -> encode -> compress -> combine
+  with the real tools and report the time and throughput of every stage.
+- Without the edit stage, check that the rebuilt archives match the originals.
+"""
+
+import os
+import sys
+import glob
+import json
+import time
+import random
+import shutil
+import struct
+import tempfile
+import subprocess
+
+import msg2txt
+import txt2msg
+
+HEADER_SIZE = 0x30
+CHUNK_SIZE = 0x800
+PADDED_CLUT_SIZE = CHUNK_SIZE - HEADER_SIZE
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+EXE_SUFFIX = '.exe' if os.name == 'nt' else ''
+TOOLS = ['MELTTIMTool', 'MSGTool']
+
+# 翡    ڵ (  msg2txt.py  )
+MSG_CONTROL_CODES = [0xfb08, 0xfb09, 0xfb0a, 0xfb0b, 0xfb0f, 0xfb18, 0xfb1a, 0xfb20, 0xfb22, 0xfb24, 0xfb2e, 0xfd00]
+
+# TXT ٲٰ ٽ ȯص  ڵ尡  ڸ  (ASCII ɾ   Ƿ )
+MOJI_CODES = [code for char, code in txt2msg.Moji_list.items() if len(char) == 1 and ord(char) > 0x7f and not char.isspace()]
+
+def tool_path(name):
+    return os.path.join(SCRIPT_DIR, name + EXE_SUFFIX)
+
+def build_tools():
+    subprocess.run(['make', '-C', SCRIPT_DIR, *TOOLS, f'PYTHON={sys.executable}'], check=True, stdout=subprocess.DEVNULL)
+
+def run_tool(*args):
+    subprocess.run(args, check=True, stdout=subprocess.DEVNULL)
+
+def run_script(name, *args):
+    run_tool(sys.executable, os.path.join(SCRIPT_DIR, name), *args)
+
+def pad_to_multiple_of(value, multiple):
+    return (value + multiple - 1) // multiple * multiple
+
+# ī̺ ׸ ϳ (0x30  + 0x800  е )
+def make_entry(kind, size, payload, fields=()):
+    padded_size = pad_to_multiple_of(HEADER_SIZE + len(payload), CHUNK_SIZE)
+    header = bytearray(HEADER_SIZE)
+    struct.pack_into('<III', header, 0, kind, size, padded_size // CHUNK_SIZE)
+    for offset, value in fields:
+        struct.pack_into('<H', header, offset, value)
+    return bytes(header) + payload + bytes(padded_size - HEADER_SIZE - len(payload))
+
+# 8x8 Ÿ ݺؼ   Ǵ ̹  (Ϻ Ÿ )
+def make_image(rng, width_bytes, height):
+    tiles = [bytes(rng.randrange(256) for _ in range(64)) for _ in range(16)]
+    image = bytearray(width_bytes * height)
+    for ty in range(0, height, 8):
+        for tx in range(0, width_bytes, 8):
+            tile = rng.choice(tiles) if rng.random() < 0.85 else bytes(rng.randrange(256) for _ in range(64))
+            for y in range(8):
+                start = (ty + y) * width_bytes + tx
+                image[start:start + 8] = tile[y * 8:y * 8 + 8]
+    return bytes(image)
+
+def make_clut(rng, colors):
+    return b''.join(struct.pack('<H', rng.randrange(0x10000)) for _ in range(colors))
+
+# ī̺꿡   ٽ    ũⰡ ǵ ȼ ʹ 0x800 
+def random_image_size(rng):
+    width_bytes = rng.choice([64, 128, 256])
+    height = rng.choice([64, 128, 256])
+    return width_bytes, height
+
+def tim_fields(rng, palette_colors, number_of_palettes, width_bytes, height):
+    return [
+        (0x0c, rng.randrange(0, 1024, 16)),     # paletteFramebufferX
+        (0x0e, rng.randrange(480, 512)),        # paletteFramebufferY
+        (0x10, palette_colors),
+        (0x12, number_of_palettes),
+        (0x14, rng.randrange(320, 1024, 64)),   # imageFramebufferX (ؽó )
+        (0x16, rng.choice([0, 256])),           # imageFramebufferY
+        (0x18, width_bytes // 2 if width_bytes else 0),
+        (0x1a, height),
+    ]
+
+def make_tim_entry(rng):
+    width_bytes, height = random_image_size(rng)
+    palette_colors = rng.choice([0x10, 0x100])
+    clut = make_clut(rng, 0x80 if palette_colors == 0x10 else 0x100)
+    pixels = make_image(rng, width_bytes, height)
+    payload = clut + bytes(PADDED_CLUT_SIZE - len(clut)) + pixels
+    return make_entry(2, len(payload), payload, tim_fields(rng, palette_colors, 1, width_bytes, height))
+
+def make_clt_entry(rng):
+    clut = make_clut(rng, 0x100)
+    return make_entry(2, len(clut), clut, tim_fields(rng, 0x100, 1, 0, 0))
+
+def make_pix_entry(rng):
+    width_bytes, height = random_image_size(rng)
+    payload = bytes(PADDED_CLUT_SIZE) + make_image(rng, width_bytes, height)
+    return make_entry(2, len(payload), payload, tim_fields(rng, 0, 0, width_bytes, height))
+
+# MTIM MELTTIMTool  ؼ 
+def make_mtim_entry(rng):
+    width_bytes, height = random_image_size(rng)
+    pixels = make_image(rng, width_bytes, height)
+    header = make_entry(3, len(pixels), b'', tim_fields(rng, 0x10, 1, width_bytes, height))[:HEADER_SIZE]
+
+    with tempfile.TemporaryDirectory() as temp_folder:
+        pix_file = os.path.join(temp_folder, '0000_GEN.PIX')
+        mtim_file = os.path.join(temp_folder, '0000_GEN.MTIM')
+        header_file = os.path.join(temp_folder, 'HEADER.BIN')
+        with open(pix_file, 'wb') as f:
+            f.write(pixels)
+        with open(header_file, 'wb') as f:
+            f.write(header)
+        open(mtim_file, 'wb').close()
+
+        run_tool(tool_path('MELTTIMTool'), 'c', pix_file, mtim_file)
+
+        with open(header_file, 'rb') as f:
+            header = bytearray(f.read(HEADER_SIZE))
+        with open(mtim_file, 'rb') as f:
+            payload = f.read()
+
+    padded_size = pad_to_multiple_of(HEADER_SIZE + len(payload), CHUNK_SIZE)
+    struct.pack_into('<I', header, 0x08, padded_size // CHUNK_SIZE)
+    return bytes(header) + payload + bytes(padded_size - HEADER_SIZE - len(payload))
+
+def make_message(rng):
+    message = bytearray()
+    for _ in range(rng.randint(2, 6)):
+        for _ in range(rng.randint(4, 24)):
+            message += rng.choice(MOJI_CODES)
+        if rng.random() < 0.6:
+            code = rng.choice(MSG_CONTROL_CODES)
+            count, width, _ = msg2txt.LEGACY_CODES[code]
+            message += code.to_bytes(2, 'big')
+            for _ in range(count):
+                message += rng.randrange(1 << (8 * width)).to_bytes(width, 'big')
+        message += b'\xfc'  # line
+    message += b'\xff'  # end
+    return bytes(message)
+
+#  ̺ +  ( ʹ  )
+def make_msg_entry(rng):
+    messages = [make_message(rng) for _ in range(rng.randint(20, 80))]
+    table_size = (len(messages) + 1) * 2
+    pointers = []
+    offset = table_size
+    for message in messages:
+        pointers.append(offset)
+        offset += len(message)
+    pointers.append(offset)
+    payload = b''.join(struct.pack('<H', pointer) for pointer in pointers) + b''.join(messages)
+    return make_entry(0x12, len(payload), payload)
+
+def make_dat_entry(rng):
+    payload = bytes(rng.randrange(256) for _ in range(rng.randrange(0x1000, 0x4000)))
+    return make_entry(0, len(payload), payload)
+
+ENTRY_MIX = [
+    (make_tim_entry, 3),
+    (make_clt_entry, 1),
+    (make_pix_entry, 1),
+    (make_mtim_entry, 2),
+    (make_msg_entry, 2),
+    (make_dat_entry, 1),
+]
+
+def generate_archives(output_folder, archive_count, seed, log=sys.stdout):
+    rng = random.Random(seed)
+    os.makedirs(output_folder, exist_ok=True)
+    for index in range(archive_count):
+        makers = [maker for maker, weight in ENTRY_MIX for _ in range(weight)]
+        makers += [rng.choice(makers) for _ in range(rng.randint(0, 4))]
+        rng.shuffle(makers)
+
+        archive_file = os.path.join(output_folder, f'ST{index:02X}.BIN')
+        with open(archive_file, 'wb') as f:
+            for maker in makers:
+                f.write(maker(rng))
+            f.write(bytes(CHUNK_SIZE))  # 
+        print(f"Generated {archive_file} ({len(makers)} entries)", file=log)
+
+class Stage:
+    def __init__(self, name):
+        self.name = name
+        self.files = 0
+        self.bytes = 0
+        self.seconds = 0.0
+
+    def add(self, file_path):
+        self.files += 1
+        self.bytes += os.path.getsize(file_path)
+
+    def __enter__(self):
+        self.start = time.perf_counter()
+        return self
+
+    def __exit__(self, *_):
+        self.seconds += time.perf_counter() - self.start
+
+#   ϳ ٸ ڷ ٲٰ, ̹ պκ ٲ
+def edit_files(stage, txt_files, pix_files):
+    moji_chars = [char for char, code in txt2msg.Moji_list.items() if code in MOJI_CODES]
+    for txt_file in txt_files:
+        stage.add(txt_file)
+        with open(txt_file, 'r', encoding='utf-8') as f:
+            text = f.read()
+        with open(txt_file, 'w', encoding='utf-8', newline='\n') as f:
+            f.write(text.replace(moji_chars[0], moji_chars[1]))
+    for pix_file in pix_files:
+        stage.add(pix_file)
+        with open(pix_file, 'r+b') as f:
+            data = bytearray(f.read(0x100))
+            f.seek(0)
+            f.write(bytes(b ^ 0x11 for b in data))
+
+def run_pipeline(input_folder, work_folder, edit=True):
+    archives = sorted(glob.glob(os.path.join(input_folder, '*.BIN')))
+    if not archives:
+        print(f"No BIN archives found in {input_folder}")
+        sys.exit(1)
+
+    extract_folder = os.path.join(work_folder, 'extract')
+    pix_folder = os.path.join(work_folder, 'pix')
+    output_folder = os.path.join(work_folder, 'output')
+    for folder in (extract_folder, pix_folder, output_folder):
+        shutil.rmtree(folder, ignore_errors=True)
+        os.makedirs(folder)
+
+    names = [os.path.splitext(os.path.basename(archive))[0] for archive in archives]
+    stages = []
+
+    with Stage('extract') as stage:
+        for archive in archives:
+            stage.add(archive)
+            run_script('combbin.py', '-x', archive, extract_folder)
+    stages.append(stage)
+
+    with Stage('decompress') as stage:
+        for name in names:
+            os.makedirs(os.path.join(pix_folder, name))
+            for mtim_file in sorted(glob.glob(os.path.join(extract_folder, name, '*.MTIM'))):
+                stage.add(mtim_file)
+                run_tool(tool_path('MELTTIMTool'), 'd', mtim_file, '-', os.path.join(pix_folder, name))
+    stages.append(stage)
+
+    with Stage('decode') as stage:
+        for msg_file in sorted(glob.glob(os.path.join(extract_folder, '*', '*.MSG'))):
+            stage.add(msg_file)
+            run_tool(tool_path('MSGTool'), 'd', msg_file, os.path.splitext(msg_file)[0] + '.TXT', '0')
+    stages.append(stage)
+
+    txt_files = sorted(glob.glob(os.path.join(extract_folder, '*', '*.TXT')))
+    pix_files = sorted(glob.glob(os.path.join(pix_folder, '*', '*.PIX')))
+    if edit:
+        with Stage('edit') as stage:
+            edit_files(stage, txt_files, pix_files)
+        stages.append(stage)
+
+    #  ũ   ٽ ϹǷ HEADER.BIN  
+    with Stage('encode') as stage:
+        for txt_file in txt_files:
+            stage.add(txt_file)
+            run_tool(tool_path('MSGTool'), 'e', txt_file)
+            os.remove(txt_file)
+    stages.append(stage)
+
+    with Stage('compress') as stage:
+        for pix_file in pix_files:
+            stage.add(pix_file)
+            name = os.path.basename(os.path.dirname(pix_file))
+            mtim_file = os.path.join(extract_folder, name, os.path.splitext(os.path.basename(pix_file))[0] + '.MTIM')
+            run_tool(tool_path('MELTTIMTool'), 'c', pix_file, mtim_file)
+    stages.append(stage)
+
+    with Stage('combine') as stage:
+        for name in names:
+            run_script('combbin.py', '-c', os.path.join(extract_folder, name), output_folder)
+            stage.add(os.path.join(output_folder, name + '.BIN'))
+    stages.append(stage)
+
+    result = {
+        'archives': len(archives),
+        'input_bytes': sum(os.path.getsize(archive) for archive in archives),
+        'stages': [{'name': s.name, 'files': s.files, 'bytes': s.bytes, 'seconds': round(s.seconds, 6)} for s in stages],
+        'total_seconds': round(sum(s.seconds for s in stages), 6),
+    }
+
+    #  ʾҴٸ  Ȱ ٽ  
+    if not edit:
+        mismatches = []
+        for archive, name in zip(archives, names):
+            with open(archive, 'rb') as a, open(os.path.join(output_folder, name + '.BIN'), 'rb') as b:
+                if a.read() != b.read():
+                    mismatches.append(name)
+        result['mismatches'] = mismatches
+    return result
+
+def throughput(byte_count, seconds):
+    return byte_count / seconds / (1 << 20) if seconds > 0 else 0.0
+
+def print_report(result):
+    print(f"{'stage':<12}{'files':>8}{'MiB':>10}{'seconds':>10}{'MiB/s':>10}")
+    for stage in result['stages']:
+        print(f"{stage['name']:<12}{stage['files']:>8}{stage['bytes'] / (1 << 20):>10.2f}"
+              f"{stage['seconds']:>10.3f}{throughput(stage['bytes'], stage['seconds']):>10.2f}")
+    total_mib = result['input_bytes'] / (1 << 20)
+    print(f"{'total':<12}{result['archives']:>8}{total_mib:>10.2f}{result['total_seconds']:>10.3f}"
+          f"{throughput(result['input_bytes'], result['total_seconds']):>10.2f}")
+    if 'mismatches' in result:
+        if result['mismatches']:
+            print(f"Rebuilt archives differ from the originals: {', '.join(result['mismatches'])}")
+        else:
+            print("Rebuilt archives match the originals.")
+
+if __name__ == '__main__':
+    flags = [arg for arg in sys.argv[1:] if arg.startswith('--')]
+    args = [arg for arg in sys.argv[1:] if not arg.startswith('--')]
+    as_json = '--json' in flags
+    edit = '--no-edit' not in flags
+
+    if len(args) < 2 or args[0] not in ('-g', '-r', '-a'):
+        print("Usage: python benchmark.py -g <output_folder> [<archive_count>] [<seed>]            # generate mode")
+        print("       python benchmark.py -r <input_folder> <work_folder> [--no-edit] [--json]     # run mode")
+        print("       python benchmark.py -a <work_folder> [<archive_count>] [<seed>] [--no-edit] [--json]  # generate and run")
+        sys.exit(1)
+
+    mode = args[0]
+    build_tools()
+
+    if mode == '-r':
+        result = run_pipeline(args[1], args[2], edit)
+    else:
+        input_folder = args[1] if mode == '-g' else os.path.join(args[1], 'input')
+        archive_count = int(args[2]) if len(args) > 2 else 8
+        seed = int(args[3]) if len(args) > 3 else 0
+        generate_archives(input_folder, archive_count, seed, sys.stderr if as_json else sys.stdout)
+        if mode == '-g':
+            sys.exit(0)
+        result = run_pipeline(input_folder, args[1], edit)
+
+    if as_json:
+        print(json.dumps(result))
+    else:
+        print_report(result)
+
+    if result.get('mismatches'):
+        sys.exit(1)
@@ -0,0 +1,246 @@
+# -*- coding: cp949 -*-
+"""
+cdimage.py
+
+Description: Module to read files straight from a raw CD image (BIN/CUE, 2352-byte sectors).
+Author: happy_land
+Date: 26-10-18
+Last update: --
+
+Functionality:
+- Open a CUE sheet, a raw BIN image (2352-byte Mode 1/Mode 2 sectors) or an ISO (2048-byte sectors).
+- Parse the ISO9660 directory tree of the data track.
+- Open a file of the image as a read-only stream that strips the sector framing on the fly,
+  so BIN archives can be parsed without extracting them to disk first.
+"""
+
+import io
+import os
+import sys
+import struct
+
+RAW_SECTOR_SIZE = 2352
+DATA_SECTOR_SIZE = 2048
+SYNC_PATTERN = b'\x00' + b'\xff' * 10 + b'\x00'
+
+#     ġ
+MODE1_DATA_OFFSET = 0x10    # (12) + (4)
+MODE2_DATA_OFFSET = 0x18    # (12) + (4) + (8)
+
+PVD_SECTOR = 16             # Primary Volume Descriptor
+READ_SECTORS = 0x100        #   д   (512KB)
+
+ISO_DIRECTORY = 0x02        # ͸ ڵ ÷
+
+def parse_cue(cue_file):
+    """CUE Ʈ ù  Ʈ (BIN ,  ũ) ȯ"""
+    folder = os.path.dirname(os.path.abspath(cue_file))
+    bin_file = None
+    with open(cue_file, 'r', encoding='utf-8', errors='replace') as f:
+        for line in f:
+            words = line.strip().split()
+            if not words:
+                continue
+            keyword = words[0].upper()
+            if keyword == 'FILE':
+                # FILE "̸  .bin" BINARY
+                rest = line.strip()[4:].strip()
+                if rest.startswith('"'):
+                    name = rest[1:rest.index('"', 1)]
+                else:
+                    name = rest.rsplit(None, 1)[0]
+                bin_file = os.path.join(folder, name)
+            elif keyword == 'TRACK' and len(words) >= 3:
+                mode = words[2].upper()
+                if mode in ('MODE1/2352', 'MODE2/2352'):
+                    return bin_file, RAW_SECTOR_SIZE
+                if mode in ('MODE1/2048', 'MODE2/2048'):
+                    return bin_file, DATA_SECTOR_SIZE
+    raise ValueError(f"Error: No data track in {cue_file}")
+
+class CdFile(io.RawIOBase):
+    """̹   ϳ (ӵ ) Ϲ ó д Ʈ"""
+
+    def __init__(self, image, lba, size, name='', close_image=False):
+        self.image = image
+        self.close_image = close_image
+        self.lba = lba
+        self.size = size
+        self.name = name
+        self.pos = 0
+
+    def readable(self):
+        return True
+
+    def seekable(self):
+        return True
+
+    def tell(self):
+        return self.pos
+
+    def seek(self, offset, whence=io.SEEK_SET):
+        if whence == io.SEEK_CUR:
+            offset += self.pos
+        elif whence == io.SEEK_END:
+            offset += self.size
+        if offset < 0:
+            raise ValueError("Error: Negative seek position")
+        self.pos = offset
+        return self.pos
+
+    def readinto(self, buffer):
+        view = memoryview(buffer).cast('B')
+        count = min(len(view), self.size - self.pos)
+        if count <= 0:
+            return 0
+
+        # ʿ ͸ о յڸ ߶
+        first = self.pos // DATA_SECTOR_SIZE
+        last = (self.pos + count - 1) // DATA_SECTOR_SIZE
+        data = self.image.read_sectors(self.lba + first, last - first + 1)
+        start = self.pos - first * DATA_SECTOR_SIZE
+        view[:count] = data[start:start + count]
+        self.pos += count
+        return count
+
+    def fileno(self):
+        raise io.UnsupportedOperation("CdFile has no file descriptor")
+
+    def close(self):
+        if not self.closed and self.close_image:
+            self.image.close()
+        super().close()
+
+class CdImage:
+    """ CD ̹ ISO9660 ͸
+
+    files: 빮  ('DATA/ST00.BIN',  ';1' ) -> ( , ũ)
+    """
+
+    def __init__(self, image_file):
+        self.image_file = image_file
+        if os.path.splitext(image_file)[1].upper() == '.CUE':
+            self.bin_file, self.sector_size = parse_cue(image_file)
+        else:
+            self.bin_file = image_file
+            self.sector_size = self.detect_sector_size(image_file)
+
+        self.f = open(self.bin_file, 'rb')
+        self.sector_count = os.fstat(self.f.fileno()).st_size // self.sector_size
+        self.files = {}
+        self.read_directory_tree()
+
+    @staticmethod
+    def detect_sector_size(bin_file):
+        with open(bin_file, 'rb') as f:
+            head = f.read(len(SYNC_PATTERN))
+        return RAW_SECTOR_SIZE if head == SYNC_PATTERN else DATA_SECTOR_SIZE
+
+    def close(self):
+        self.f.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *_):
+        self.close()
+
+    def sector_offset(self, lba):
+        """ lba ̹ Ͽ ϴ ġ"""
+        return lba * self.sector_size
+
+    def read_sectors(self, lba, count):
+        """ count   (2048Ʈ) ̾ ٿ ȯ"""
+        if lba < 0 or lba + count > self.sector_count:
+            raise ValueError(f"Error: Sectors {lba}-{lba + count - 1} are outside the image")
+
+        output = bytearray(count * DATA_SECTOR_SIZE)
+        done = 0
+        while done < count:
+            batch = min(count - done, READ_SECTORS)
+            self.f.seek(self.sector_offset(lba + done))
+            raw = self.f.read(batch * self.sector_size)
+            if len(raw) < batch * self.sector_size:
+                raise IOError("Error: Unexpected end of the image")
+
+            if self.sector_size == DATA_SECTOR_SIZE:
+                output[done * DATA_SECTOR_SIZE:(done + batch) * DATA_SECTOR_SIZE] = raw
+            else:
+                raw = memoryview(raw)
+                for i in range(batch):
+                    sector = i * RAW_SECTOR_SIZE
+                    #   Ʈ (0x0f)  ġ 
+                    data_offset = MODE1_DATA_OFFSET if raw[sector + 0x0f] == 1 else MODE2_DATA_OFFSET
+                    out = (done + i) * DATA_SECTOR_SIZE
+                    output[out:out + DATA_SECTOR_SIZE] = raw[sector + data_offset:sector + data_offset + DATA_SECTOR_SIZE]
+            done += batch
+        return output
+
+    def read_directory_tree(self):
+        pvd = self.read_sectors(PVD_SECTOR, 1)
+        if pvd[0] != 1 or pvd[1:6] != b'CD001':
+            raise ValueError(f"Error: {self.image_file} is not an ISO9660 image")
+
+        # PVD 0x9c Ʈ ͸ ڵ
+        root_lba, root_size = struct.unpack_from('<I4xI', pvd, 0x9c + 0x02)
+        folders = [('', root_lba, root_size)]
+        visited = set()
+        while folders:
+            prefix, lba, size = folders.pop()
+            if lba in visited:
+                continue
+            visited.add(lba)
+
+            data = self.read_sectors(lba, (size + DATA_SECTOR_SIZE - 1) // DATA_SECTOR_SIZE)
+            offset = 0
+            while offset < size:
+                length = data[offset]
+                if length == 0:
+                    # ڵ  踦  Ƿ  ͷ
+                    offset = (offset // DATA_SECTOR_SIZE + 1) * DATA_SECTOR_SIZE
+                    continue
+
+                entry_lba, entry_size = struct.unpack_from('<I4xI', data, offset + 0x02)
+                flags = data[offset + 0x19]
+                name_length = data[offset + 0x20]
+                name = bytes(data[offset + 0x21:offset + 0x21 + name_length])
+                offset += length
+
+                if name in (b'\x00', b'\x01'):  # .  ..
+                    continue
+                name = name.decode('ascii', errors='replace').split(';')[0].upper()
+                path = prefix + name
+                if flags & ISO_DIRECTORY:
+                    folders.append((path + '/', entry_lba, entry_size))
+                else:
+                    self.files[path] = (entry_lba, entry_size)
+
+    def find(self, path):
+        key = path.replace('\\', '/').strip('/').split(';')[0].upper()
+        if key not in self.files:
+            raise FileNotFoundError(f"Error: {path} is not in {self.image_file}")
+        return self.files[key]
+
+    def open(self, path, close_image=False):
+        """̹   б  Ʈ  (close_image Ʈ Բ ̹ )"""
+        lba, size = self.find(path)
+        raw = CdFile(self, lba, size, path, close_image)
+        return io.BufferedReader(raw, buffer_size=READ_SECTORS * DATA_SECTOR_SIZE)
+
+    def read_file(self, path):
+        lba, size = self.find(path)
+        return bytes(self.read_sectors(lba, (size + DATA_SECTOR_SIZE - 1) // DATA_SECTOR_SIZE)[:size])
+
+if __name__ == '__main__':
+    if len(sys.argv) not in (2, 4):
+        print("Usage: python cdimage.py <image>                         # list files")
+        print("       python cdimage.py <image> <path> <output_file>    # copy one file out")
+        sys.exit(1)
+
+    with CdImage(sys.argv[1]) as image:
+        if len(sys.argv) == 2:
+            for path, (lba, size) in sorted(image.files.items()):
+                print(f"{lba:7d} {size:10d}  {path}")
+        else:
+            with open(sys.argv[3], 'wb') as output_file:
+                output_file.write(image.read_file(sys.argv[2]))
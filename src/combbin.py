@@ -10,12 +10,18 @@ Last update: --
 Functionality:
 - Merge multiple BIN files into a single archive file.
 - Split a single BIN archive file into multiple files.
+- Split every BIN archive in a folder in parallel, storing identical files once.
+- Split the BIN archives straight from a raw CD image (BIN/CUE) without copying them out first.
 """
 
 import os
 import glob
 import struct
 import sys
+import hashlib
+import concurrent.futures
+
+import cdimage
 
 HEADER_SIZE = 0x30
 CHUNK_SIZE = 0x800
@@ -47,6 +53,111 @@ def read_tim_headers(file_path):
         
     return (palette_framebuffer_x, palette_framebuffer_y), clut_data, (image_framebuffer_x, image_framebuffer_y, image_width, image_height), color_type
 
+def copy_range(src_fd, dst_fd, offset, count):
+    """src_fd offset count Ʈ dst_fd  ġ  (Ŀ   켱)"""
+    # copy_file_range:   ý̸ øũ(btrfs, XFS) Ǵ Ŀ  
+    if hasattr(os, 'copy_file_range'):
+        try:
+            while count > 0:
+                copied = os.copy_file_range(src_fd, dst_fd, count, offset)
+                if copied == 0:
+                    break
+                offset += copied
+                count -= copied
+            if count == 0:
+                return
+        except OSError:
+            pass
+
+    # sendfile: ٸ  ý ̿     
+    if hasattr(os, 'sendfile'):
+        try:
+            while count > 0:
+                sent = os.sendfile(dst_fd, src_fd, offset, count)
+                if sent == 0:
+                    break
+                offset += sent
+                count -= sent
+            if count == 0:
+                return
+        except OSError:
+            pass
+
+    #   (Windows ):  ũ ۷ 
+    while count > 0:
+        os.lseek(src_fd, offset, os.SEEK_SET)
+        chunk = os.read(src_fd, min(count, 0x100000))
+        if not chunk:
+            raise IOError("Error: Unexpected end of file while copying")
+        os.write(dst_fd, chunk)
+        offset += len(chunk)
+        count -= len(chunk)
+
+def plan_entry(file_header, file_path):
+    """ ϳ ī̺ ׸ ġϴ  
+
+    ȯ: (, տ  ,  ,  ,  е )
+      ʰ  Ͽ ״ Ѵ.
+    """
+    file_header = bytearray(file_header)
+    file_extension = os.path.splitext(file_path)[1][1:].upper()
+    file_size = os.path.getsize(file_path)
+
+    prefix_data = b''
+    body_offset = 0
+
+    # Ȯڰ TIM 
+    if file_extension == 'TIM':
+        tim_header, clut_data, image_header, color_type = read_tim_headers(file_path)
+
+        # TIM  ο  
+        struct.pack_into('<HH', file_header, 0x0c, *tim_header)
+        struct.pack_into('<HHHH', file_header, 0x14, *image_header)
+
+        # CLUT ͸ еϿ   
+        clut_padded_size = pad_to_multiple_of(len(clut_data), CHUNK_SIZE)
+        clut_padding_needed = clut_padded_size - len(clut_data) - HEADER_SIZE
+        prefix_data = clut_data + (b'\x00' * clut_padding_needed)
+        #    (ȼ ͸)
+        body_offset = 0x220 if color_type == BITS8 else 0x120  # 4Ʈ
+    elif file_extension == 'PIX':
+        prefix_data = b'\x00' * PADDED_CLUT_SIZE
+
+    body_size = max(file_size - body_offset, 0)
+    data_size = len(prefix_data) + body_size
+
+    # 0x800  ߱  е 
+    padded_size = pad_to_multiple_of(HEADER_SIZE + data_size, CHUNK_SIZE)
+    padding_needed = padded_size - (HEADER_SIZE + data_size)
+
+    #  ũ⸦ Ʈ
+    if not file_extension in exception_list:
+        struct.pack_into('<I', file_header, 0x04, data_size)
+    # е ũ⸦ Ʈ
+    padded_size_num = padded_size // CHUNK_SIZE
+    struct.pack_into('<I', file_header, 0x08, padded_size_num)
+
+    return file_header, prefix_data, body_offset, body_size, padding_needed
+
+def write_entry(output_fd, entry, file_path, zero_chunk):
+    """plan_entry()  ׸ ϳ output_fd  ġ """
+    file_header, prefix_data, body_offset, body_size, padding_needed = entry
+
+    #  պκ  ۷   
+    os.write(output_fd, bytes(file_header) + prefix_data)
+
+    #   Ͽ  
+    if body_size:
+        input_fd = os.open(file_path, os.O_RDONLY | getattr(os, 'O_BINARY', 0))
+        try:
+            copy_range(input_fd, output_fd, body_offset, body_size)
+        finally:
+            os.close(input_fd)
+
+    # е ߰
+    if padding_needed:
+        os.write(output_fd, zero_chunk[:padding_needed])
+
 def combine_files(input_folder, output_folder):
     header_filename = os.path.join(input_folder, 'HEADER.BIN')
     output_filename = os.path.join(output_folder, os.path.basename(input_folder) + '.BIN')
@@ -73,62 +184,29 @@ def combine_files(input_folder, output_folder):
     if len(file_groups) != num_files:
         raise ValueError(f"Error: Number of files ({len(file_groups)}) does not match number of headers ({num_files})")
 
+    #   ü ġ  
+    layout = []
+    for index in range(num_files):
+        # ش ε شϴ  
+        file_header = header_data[index * HEADER_SIZE:(index + 1) * HEADER_SIZE]
+        file_name = f'{index:04d}_{folder_name}'
+        if file_name not in file_groups:
+            raise ValueError(f"Error: File {file_name} not found.")
+
+        file_path = file_groups[file_name]
+        layout.append((plan_entry(file_header, file_path), file_path))
+
     os.makedirs(output_folder, exist_ok=True)
-    with open(output_filename, 'wb') as output_file:
-        for index in range(num_files):
-            # ش ε شϴ  
-            file_header = bytearray(header_data[index * HEADER_SIZE:(index + 1) * HEADER_SIZE])
-            file_name = f'{index:04d}_{folder_name}'
-            if file_name not in file_groups:
-                raise ValueError(f"Error: File {file_name} not found.")
-                
-            file_path = file_groups[file_name]
-            file_extension = os.path.splitext(file_path)[1][1:].upper()
-
-            with open(file_path, 'rb') as input_file:
-                file_data = input_file.read()
-
-            # Ȯڰ TIM 
-            if file_extension == 'TIM':
-                tim_header, clut_data, image_header, color_type = read_tim_headers(file_path)
-
-                # TIM  ο  
-                struct.pack_into('<HH', file_header, 0x0c, *tim_header)
-                struct.pack_into('<HHHH', file_header, 0x14, *image_header)
-
-                # CLUT ͸ еϿ   
-                clut_padded_size = pad_to_multiple_of(len(clut_data), CHUNK_SIZE)
-                clut_padding_needed = clut_padded_size - len(clut_data) - HEADER_SIZE
-                clut_data += (b'\x00' * clut_padding_needed)
-                #    (ȼ ͸)
-                if color_type == BITS8:
-                    file_data = file_data[0x220:]
-                else:
-                    file_data = file_data[0x120:]  # 4Ʈ
-                file_data = clut_data + file_data
-            elif file_extension == 'PIX':
-                file_data = (b'\x00' * PADDED_CLUT_SIZE) + file_data
-
-            # 0x800  ߱  е 
-            padded_size = pad_to_multiple_of(HEADER_SIZE + len(file_data), CHUNK_SIZE)
-            padding_needed = padded_size - (HEADER_SIZE + len(file_data))
-
-            #  ũ⸦ Ʈ
-            if not file_extension in exception_list:
-                struct.pack_into('<I', file_header, 0x04, len(file_data))
-            # е ũ⸦ Ʈ
-            padded_size_num = padded_size // CHUNK_SIZE
-            struct.pack_into('<I', file_header, 0x08, padded_size_num)
-
-            #   ͸  Ͽ 
-            output_file.write(file_header)
-            output_file.write(file_data)
-
-            # е ߰
-            output_file.write(b'\x00' * padding_needed)
+    zero_chunk = bytes(CHUNK_SIZE)
+    output_fd = os.open(output_filename, os.O_WRONLY | os.O_CREAT | os.O_TRUNC | getattr(os, 'O_BINARY', 0), 0o644)
+    try:
+        for entry, file_path in layout:
+            write_entry(output_fd, entry, file_path, zero_chunk)
 
         # յ   0x800   ߰
-        output_file.write(b'\x00' * CHUNK_SIZE)
+        os.write(output_fd, zero_chunk)
+    finally:
+        os.close(output_fd)
 
     print(f"Combined file created: {output_filename}")
 
@@ -236,12 +314,81 @@ def create_tim_header(header_data, data, file_size):
     tim_header += clut_data + Image_header
     return tim_header
 
-def extract_files(input_file, output_folder):
+def convert_entry(header_data, file_content):
+    """ī̺ ׸ ϳ   (Ȯ, ) ȯ"""
+    file_kind, file_size = struct.unpack_from('<II', header_data, 0)
+    file_extension = get_extension(file_kind, header_data)
+
+    prefix_data = b''
+    if file_extension == "TIM":
+        prefix_data = create_tim_header(header_data, file_content, file_size)
+        file_content = file_content[PADDED_CLUT_SIZE:]  # ȼ 
+    elif file_extension == "PIX":
+        file_content = file_content[PADDED_CLUT_SIZE:]
+        file_size = len(file_content)
+
+    # file_size  ũⰡ ƴ 
+    if file_extension in exception_list:  #  
+        return file_extension, prefix_data + file_content  # ״ 
+    # е 
+    return file_extension, prefix_data + file_content[:file_size]
+
+def replace_file(output_filename, data):
+    """ӽ Ͽ   ü (-X ϵ帵ũ ̸  θ   )"""
+    temp_path = f"{output_filename}.tmp"
+    with open(temp_path, 'wb') as output_file:
+        output_file.write(data)
+    os.replace(temp_path, output_filename)
+
+def store_file(output_filename, data, store_folder):
+    """ ؽ÷ ҿ   ϰ output_filename ϵ帵ũ 
+
+    ̹   Ǿ  True ȯѴ.
+    """
+    digest = hashlib.blake2b(data, digest_size=16).hexdigest()
+    object_path = os.path.join(store_folder, digest[:2], digest[2:])
+
+    exists = os.path.exists(object_path)
+    if not exists:
+        os.makedirs(os.path.dirname(object_path), exist_ok=True)
+        # ٸ μ  ʵ ӽ Ͽ   ü
+        temp_path = f"{object_path}.{os.getpid()}"
+        with open(temp_path, 'wb') as object_file:
+            object_file.write(data)
+        os.replace(temp_path, object_path)
+
+    if os.path.lexists(output_filename):
+        os.remove(output_filename)
+    try:
+        os.link(object_path, output_filename)
+    except OSError:
+        # ϵ帵ũ  ʴ  ý̸ ׳ 
+        with open(output_filename, 'wb') as output_file:
+            output_file.write(data)
+    return exists
+
+def open_archive(input_file, image_file=None):
+    """ī̺긦  (image_file  input_file CD ̹  )"""
+    if image_file is None:
+        return open(input_file, 'rb')
+    # Ʈ  ̹ 
+    return cdimage.CdImage(image_file).open(input_file, close_image=True)
+
+def decompress_entry(header_data, file_content, output_filename):
+    """MTIM ׸ libdash2 ٷ   PIX  (MELTTIMTool d  )"""
+    import dash2  # libdash2.so ʿ  
+    replace_file(output_filename, dash2.decompress(header_data, file_content))
+
+def extract_files(input_file, output_folder, store_folder=None, image_file=None, pix_folder=None):
     basename = os.path.splitext(os.path.basename(input_file))[0]
     os.makedirs(f"{output_folder}/{basename}", exist_ok=True)
-    
-    with open(input_file, 'rb') as f:
-        file_count = 0
+    if pix_folder:
+        os.makedirs(f"{pix_folder}/{basename}", exist_ok=True)
+
+    file_count = 0
+    dedup_count = 0
+    dedup_bytes = 0
+    with open_archive(input_file, image_file) as f:
         headers = []
 
         while True:
@@ -262,24 +409,18 @@ def extract_files(input_file, output_folder):
                 print("Error: Could not read the expected padded size")
                 break
             
-            file_extension = get_extension(file_kind, header_data)
+            file_extension, output_data = convert_entry(header_data, file_content)
             output_filename = f"{output_folder}/{basename}/{file_count:04d}_{basename}.{file_extension.upper()}"
             
-            with open(output_filename, 'wb') as output_file:
-                if file_extension == "TIM":
-                    tim_header = create_tim_header(header_data, file_content, file_size)
-                    file_content = file_content[PADDED_CLUT_SIZE:]  # ȼ 
-                    output_file.write(tim_header)
-                elif file_extension == "PIX":
-                    file_content = file_content[PADDED_CLUT_SIZE:]
-                    file_size = len(file_content)
-                
-                # file_size  ũⰡ ƴ 
-                if file_extension in exception_list:  #  
-                    output_file.write(file_content)  # ״ 
-                else:
-                    # е 
-                    output_file.write(file_content[:file_size])
+            if store_folder:
+                if store_file(output_filename, output_data, store_folder):
+                    dedup_count += 1
+                    dedup_bytes += len(output_data)
+            else:
+                replace_file(output_filename, output_data)
+
+            if pix_folder and file_extension == "MTIM":
+                decompress_entry(header_data, file_content, f"{pix_folder}/{basename}/{file_count:04d}_{basename}.PIX")
             
             file_count += 1
 
@@ -289,21 +430,218 @@ def extract_files(input_file, output_folder):
             header_file.write(header)
             
     print(f"Extracted files to: {output_folder}/{basename}")
+    return file_count, dedup_count, dedup_bytes
+
+def check_archive_names(archives):
+    """ī̺긶 <output_folder>/≮>/ ϹǷ ̸  ī̺갡  ߴ"""
+    names = {}
+    for archive in archives:
+        name = os.path.splitext(os.path.basename(archive))[0].upper()
+        if name in names:
+            raise ValueError(f"Error: Duplicate archive name: {names[name]} and {archive}")
+        names[name] = archive
+
+def extract_all(input_folder, output_folder, jobs=None, pix_folder=None):
+    """   BIN ī̺긦 ķ  (    )"""
+    #   HEADER.BIN ׸ (progbin NNNN_̸.BIN) ī̺갡 ƴ
+    skip_folders = [os.path.abspath(folder) + os.sep for folder in (output_folder, pix_folder) if folder]
+    archives = sorted(path for path in glob.glob(os.path.join(input_folder, '**', '*.BIN'), recursive=True)
+                      if os.path.basename(path).upper() != 'HEADER.BIN'
+                      and not any(os.path.abspath(path).startswith(folder) for folder in skip_folders))
+    check_archive_names(archives)
+    # ũⰡ ū ī̺ ؾ   μ  ð پ
+    archives.sort(key=os.path.getsize, reverse=True)
+
+    store_folder = os.path.join(output_folder, '.objects')
+    os.makedirs(store_folder, exist_ok=True)
+
+    total_files = total_dedup = total_bytes = 0
+    with concurrent.futures.ProcessPoolExecutor(max_workers=jobs) as executor:
+        # ī̺ ϳ  ֹǷ   μ  ī̺긦 
+        futures = [executor.submit(extract_files, archive, output_folder, store_folder, None, pix_folder) for archive in archives]
+        for future in concurrent.futures.as_completed(futures):
+            file_count, dedup_count, dedup_bytes = future.result()
+            total_files += file_count
+            total_dedup += dedup_count
+            total_bytes += dedup_bytes
+
+    print(f"Extracted {len(archives)} archives ({total_files} files, {total_dedup} duplicates, {total_bytes} bytes saved)")
+
+def extract_image(image_file, output_folder, jobs=None, pix_folder=None):
+    """CD ̹   BIN ī̺긦 Ϳ ٷ о ķ """
+    with cdimage.CdImage(image_file) as image:
+        archives = [(path, size) for path, (_, size) in image.files.items() if path.endswith('.BIN')]
+    check_archive_names([path for path, _ in archives])
+    archives.sort(key=lambda archive: archive[1], reverse=True)
+
+    store_folder = os.path.join(output_folder, '.objects')
+    os.makedirs(store_folder, exist_ok=True)
+
+    total_files = total_dedup = total_bytes = 0
+    with concurrent.futures.ProcessPoolExecutor(max_workers=jobs) as executor:
+        # μ ̹   
+        futures = [executor.submit(extract_files, path, output_folder, store_folder, image_file, pix_folder) for path, _ in archives]
+        for future in concurrent.futures.as_completed(futures):
+            file_count, dedup_count, dedup_bytes = future.result()
+            total_files += file_count
+            total_dedup += dedup_count
+            total_bytes += dedup_bytes
+
+    print(f"Extracted {len(archives)} archives from {image_file} ({total_files} files, {total_dedup} duplicates, {total_bytes} bytes saved)")
+
+JOURNAL_MAGIC = b'D2JN'
+
+def read_archive_layout(f):
+    """ī̺  󰡸  ׸ (, , е ũ)  ȯ"""
+    layout = []
+    offset = 0
+    while True:
+        f.seek(offset)
+        header_data = f.read(HEADER_SIZE)
+        if len(header_data) < HEADER_SIZE:
+            break
+
+        padded_size = struct.unpack_from('<I', header_data, 0x08)[0] * CHUNK_SIZE
+        if padded_size == 0:  #   ()
+            break
+
+        layout.append((offset, header_data, padded_size))
+        offset += padded_size
+    return layout
+
+def write_zeros(fd, size, zero_chunk):
+    while size > 0:
+        written = os.write(fd, zero_chunk[:min(size, len(zero_chunk))])
+        size -= written
+
+def recover_journal(archive_file):
+    """ߴܵ      ͷ ǵ"""
+    journal_file = archive_file + '.journal'
+    if not os.path.exists(journal_file):
+        return
+
+    with open(journal_file, 'rb') as journal:
+        journal_data = journal.read()
+
+    #  ü  ϵ ʾҴٸ ī̺  ǵ帮  
+    if len(journal_data) >= 12 and journal_data[:4] == JOURNAL_MAGIC:
+        offset, length = struct.unpack_from('<II', journal_data, 4)
+        original_data = journal_data[12:]
+        if len(original_data) == length:
+            with open(archive_file, 'r+b') as f:
+                f.seek(offset)
+                f.write(original_data)
+                f.flush()
+                os.fsync(f.fileno())
+            print(f"Rolled back an interrupted update at 0x{offset:08x}")
+
+    os.remove(journal_file)
+
+def update_entry(archive_file, index, input_file):
+    """ī̺ ü ٽ  ʰ ׸ ϳ ü"""
+    recover_journal(archive_file)
+
+    with open(archive_file, 'rb') as f:
+        layout = read_archive_layout(f)
+        archive_size = os.fstat(f.fileno()).st_size
+
+    if index < 0 or index >= len(layout):
+        raise ValueError(f"Error: Entry {index} is out of range (0-{len(layout) - 1})")
+
+    entry_offset, file_header, old_padded_size = layout[index]
+
+    #   HEADER.BIN    켱  (MELTTIMTool, txt2msg )
+    # combine_filesó  ̸ ī̺ ̸    ī̺  
+    input_folder = os.path.dirname(os.path.abspath(input_file))
+    header_filename = os.path.join(input_folder, 'HEADER.BIN')
+    archive_name = os.path.splitext(os.path.basename(archive_file))[0]
+    if os.path.basename(input_folder).upper() == archive_name.upper() and os.path.exists(header_filename):
+        with open(header_filename, 'rb') as header_file:
+            header_file.seek(index * HEADER_SIZE)
+            header_data = header_file.read(HEADER_SIZE)
+        if len(header_data) == HEADER_SIZE:
+            file_header = header_data
+
+    entry = plan_entry(file_header, input_file)
+    new_header, prefix_data, body_offset, body_size, padding_needed = entry
+    new_padded_size = HEADER_SIZE + len(prefix_data) + body_size + padding_needed
+    zero_chunk = bytes(CHUNK_SIZE)
+
+    if new_padded_size <= old_padded_size:
+        # ûũ     ڸ ״  ( ûũ 0 ä)
+        struct.pack_into('<I', new_header, 0x08, old_padded_size // CHUNK_SIZE)
+        entry = (new_header, prefix_data, body_offset, body_size, padding_needed + old_padded_size - new_padded_size)
+
+        #    ͸  ο 
+        with open(archive_file, 'rb') as f:
+            f.seek(entry_offset)
+            original_data = f.read(old_padded_size)
+
+        journal_file = archive_file + '.journal'
+        with open(journal_file, 'wb') as journal:
+            journal.write(JOURNAL_MAGIC + struct.pack('<II', entry_offset, len(original_data)) + original_data)
+            journal.flush()
+            os.fsync(journal.fileno())
+
+        archive_fd = os.open(archive_file, os.O_WRONLY | getattr(os, 'O_BINARY', 0))
+        try:
+            os.lseek(archive_fd, entry_offset, os.SEEK_SET)
+            write_entry(archive_fd, entry, input_file, zero_chunk)
+            os.fsync(archive_fd)
+        finally:
+            os.close(archive_fd)
+
+        os.remove(journal_file)
+        print(f"Updated entry {index:04d} in place: {archive_file}")
+        return
+
+    # ûũ  þ ӽ Ͽ   ü
+    tail_offset = entry_offset + old_padded_size
+    temp_file = archive_file + '.tmp'
+    archive_fd = os.open(archive_file, os.O_RDONLY | getattr(os, 'O_BINARY', 0))
+    output_fd = os.open(temp_file, os.O_WRONLY | os.O_CREAT | os.O_TRUNC | getattr(os, 'O_BINARY', 0), 0o644)
+    try:
+        copy_range(archive_fd, output_fd, 0, entry_offset)
+        write_entry(output_fd, entry, input_file, zero_chunk)
+        copy_range(archive_fd, output_fd, tail_offset, archive_size - tail_offset)
+        os.fsync(output_fd)
+    except:
+        os.close(output_fd)
+        os.remove(temp_file)
+        raise
+    finally:
+        os.close(archive_fd)
+
+    os.close(output_fd)
+    os.replace(temp_file, archive_file)
+    print(f"Updated entry {index:04d} ({old_padded_size // CHUNK_SIZE} -> {new_padded_size // CHUNK_SIZE} chunks): {archive_file}")
 
 if __name__ == '__main__':
-    if len(sys.argv) != 4:
+    if len(sys.argv) != 4 and not (len(sys.argv) == 5 and sys.argv[1] in ('-u', '-x', '-X', '-I')):
         print("Usage: python combbin.py -c <input_folder> <output_folder>  # combine mode")
-        print("       python combbin.py -x <input_file> <output_folder>     # extract mode")
+        print("       python combbin.py -x <input_file> <output_folder> [<pix_folder>]     # extract mode")
+        print("       python combbin.py -X <input_folder> <output_folder> [<pix_folder>]   # extract all mode")
+        print("       python combbin.py -I <image_file> <output_folder> [<pix_folder>]     # extract all from a CD image (BIN/CUE)")
+        print("         (<pix_folder>: also decompress MTIM entries to PIX in memory with libdash2)")
+        print("       python combbin.py -u <archive_file> <index> <input_file>  # update mode")
         sys.exit(1)
 
     mode = sys.argv[1]
     input_path = sys.argv[2]
     output_path = sys.argv[3]
+    pix_folder = sys.argv[4] if len(sys.argv) == 5 and mode != '-u' else None
 
     if mode == '-c':
         combine_files(input_path, output_path)
     elif mode == '-x':
-        extract_files(input_path, output_path)
+        extract_files(input_path, output_path, pix_folder=pix_folder)
+    elif mode == '-X':
+        extract_all(input_path, output_path, pix_folder=pix_folder)
+    elif mode == '-I':
+        extract_image(input_path, output_path, pix_folder=pix_folder)
+    elif mode == '-u':
+        index = int(output_path, 16) if output_path.startswith('0x') else int(output_path)
+        update_entry(input_path, index, sys.argv[4])
     else:
-        print("Invalid mode. Use -c to combine or -x to extract.")
+        print("Invalid mode. Use -c to combine, -x, -X or -I to extract or -u to update.")
         sys.exit(1)
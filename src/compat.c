@@ -0,0 +1,61 @@
+/*******************************************************************************
+ *
+ *  Filename:  compat.c
+ *
+ *  Description:  fopen_s() for C libraries without Annex K (glibc, macOS),
+ *  so the tools also build outside Windows, and replace_file() for output
+ *  files. Included directly by each tool, like endian.c.
+ *
+ *  Author:  happy_land
+ *  Date:  2026-10-18
+ *  Last update:  --
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#if !defined(_WIN32) && !defined(__STDC_LIB_EXT1__)
+typedef int errno_t;
+
+errno_t fopen_s(FILE **file, const char *filename, const char *mode) {
+    *file = fopen(filename, mode);
+    return *file ? 0 : errno;
+}
+#endif
+
+// ӽ Ͽ    rename ٲ . ڸ   Ƿ
+// combbin -X ϵ帵ũ  ϵ  θ   ǰ  ״
+int replace_file(const char *path, const char *mode, const void *data, size_t size) {
+    char temp_path[1100];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    FILE *file = NULL;
+    errno_t err = fopen_s(&file, temp_path, mode);
+    if (err != 0 || file == NULL) {
+        return 1;
+    }
+    int failed = fwrite(data, 1, size, file) != size;
+    failed = fclose(file) != 0 || failed;
+
+#ifdef _WIN32
+    failed = failed || !MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING);
+#else
+    failed = failed || rename(temp_path, path) != 0;
+#endif
+    if (failed) {
+        int saved = errno;
+        remove(temp_path);
+        errno = saved;
+        return 1;
+    }
+    return 0;
+}
+
+/*==============================================================*/
+/*	"compat.c"	End of File										*/
+/*==============================================================*/
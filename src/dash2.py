@@ -0,0 +1,161 @@
+# -*- coding: cp949 -*-
+"""
+dash2.py
+
+Description: Python binding of libdash2 (the native codecs) with ctypes.
+Author: happy_land
+Date: 26-10-18
+Last update: --
+
+Functionality:
+- Decompress and compress MTIM data in memory (same results as MELTTIMTool).
+- Split and combine the font bit planes (same results as FontTool).
+- Convert a TIM to RGBA pixels.
+- Input bytes are passed to the library without copies; output buffers are allocated once here.
+"""
+
+import os
+import ctypes
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+LIBRARY_NAME = 'libdash2.dll' if os.name == 'nt' else 'libdash2.so'
+
+ABI_VERSION = 1
+HEADER_SIZE = 0x30
+
+E_ARGUMENT = -1
+E_SPACE = -2
+E_DATA = -3
+ERRORS = {E_ARGUMENT: "invalid argument", E_SPACE: "output buffer too small", E_DATA: "corrupted data"}
+
+_lib = None
+
+def load(path=None):
+    """̺귯    ( OSError, make libdash2.so / Windows make libdash2.dll )"""
+    global _lib
+    if _lib is not None:
+        return _lib
+
+    lib = ctypes.CDLL(path or os.path.join(SCRIPT_DIR, LIBRARY_NAME))
+    u8p = ctypes.c_void_p
+    size_t = ctypes.c_size_t
+    int_p = ctypes.POINTER(ctypes.c_int)
+    signatures = {
+        'dash2_abi_version': (ctypes.c_int, []),
+        'dash2_melt_decompressed_size': (ctypes.c_long, [u8p]),
+        'dash2_melt_decompress': (ctypes.c_long, [u8p, u8p, size_t, u8p, size_t]),
+        'dash2_melt_compress_bound': (size_t, [size_t]),
+        'dash2_melt_compress': (ctypes.c_long, [u8p, size_t, u8p, size_t, ctypes.POINTER(ctypes.c_uint16)]),
+        'dash2_font_split': (ctypes.c_long, [u8p, size_t, u8p, u8p]),
+        'dash2_font_combine': (ctypes.c_long, [u8p, u8p, size_t, u8p]),
+        'dash2_tim_info': (ctypes.c_int, [u8p, size_t, int_p, int_p, int_p, int_p]),
+        'dash2_tim_to_rgba': (ctypes.c_long, [u8p, size_t, ctypes.c_int, u8p, size_t]),
+    }
+    for name, (restype, argtypes) in signatures.items():
+        function = getattr(lib, name)
+        function.restype = restype
+        function.argtypes = argtypes
+
+    if lib.dash2_abi_version() < ABI_VERSION:
+        raise OSError(f"{LIBRARY_NAME} is too old (ABI {lib.dash2_abi_version()} < {ABI_VERSION})")
+    _lib = lib
+    return lib
+
+def available():
+    try:
+        load()
+        return True
+    except OSError:
+        return False
+
+class _Input:
+    """bytes, bytearray, memoryview   ͷ ѱ"""
+
+    def __init__(self, data):
+        if isinstance(data, bytes):
+            self.keep = data
+            self.address = ctypes.cast(ctypes.c_char_p(data), ctypes.c_void_p).value
+        else:
+            view = memoryview(data).cast('B')
+            if view.readonly:
+                # б  ۴ bytes   
+                self.keep = bytes(view)
+                self.address = ctypes.cast(ctypes.c_char_p(self.keep), ctypes.c_void_p).value
+            else:
+                self.keep = (ctypes.c_char * len(view)).from_buffer(view)
+                self.address = ctypes.addressof(self.keep)
+        self.size = len(data) if isinstance(data, bytes) else memoryview(data).nbytes
+
+def _output(size):
+    """  bytearray   (͸  ڿ bytearray ũ⸦ ٲ  )"""
+    output = bytearray(size)
+    return output, (ctypes.c_char * size).from_buffer(output)
+
+def _check(result, what):
+    if result < 0:
+        raise ValueError(f"Error: {what}: {ERRORS.get(result, result)}")
+    return result
+
+def decompress(header, data):
+    """MTIM ׸ (0x30   ) -> PIX"""
+    lib = load()
+    header = _Input(header)
+    data = _Input(data)
+    size = _check(lib.dash2_melt_decompressed_size(header.address), "decompress")
+    output, buffer = _output(size)
+    _check(lib.dash2_melt_decompress(header.address, data.address, data.size, ctypes.addressof(buffer), size), "decompress")
+    return output
+
+def compress(data, header=None):
+    """PIX -> ( , Ʈʵ ). header ָ 0x04 0x24 ä  ȯ"""
+    lib = load()
+    data = _Input(data)
+    capacity = lib.dash2_melt_compress_bound(data.size)
+    output, buffer = _output(capacity)
+    bitfield_size = ctypes.c_uint16()
+    size = _check(lib.dash2_melt_compress(data.address, data.size, ctypes.addressof(buffer), capacity, ctypes.byref(bitfield_size)), "compress")
+    del buffer
+    del output[size:]
+    if header is None:
+        return output, bitfield_size.value
+
+    header = bytearray(header[:HEADER_SIZE])
+    header[0x04:0x08] = data.size.to_bytes(4, 'little')
+    header[0x24:0x26] = bitfield_size.value.to_bytes(2, 'little')
+    return output, header
+
+def split_font(data):
+    """Ʈ PIX -> (FONT1, FONT2) Ʈ """
+    lib = load()
+    data = _Input(data)
+    font1, buffer1 = _output(data.size)
+    font2, buffer2 = _output(data.size)
+    _check(lib.dash2_font_split(data.address, data.size, ctypes.addressof(buffer1), ctypes.addressof(buffer2)), "split")
+    return font1, font2
+
+def combine_font(font1, font2):
+    lib = load()
+    font1 = _Input(font1)
+    font2 = _Input(font2)
+    if font1.size != font2.size:
+        raise ValueError("Error: Font planes must be of the same size")
+    output, buffer = _output(font1.size)
+    _check(lib.dash2_font_combine(font1.address, font2.address, font1.size, ctypes.addressof(buffer)), "combine")
+    return output
+
+def tim_info(data):
+    """TIM -> (ʺ, , bpp, ȷƮ )"""
+    lib = load()
+    data = _Input(data)
+    values = [ctypes.c_int() for _ in range(4)]
+    _check(lib.dash2_tim_info(data.address, data.size, *[ctypes.byref(value) for value in values]), "tim_info")
+    return tuple(value.value for value in values)
+
+def tim_to_rgba(data, palette=0):
+    """TIM -> (ʺ, , RGBA Ʈ)"""
+    lib = load()
+    width, height, _, _ = tim_info(data)
+    data = _Input(data)
+    output, buffer = _output(width * height * 4)
+    _check(lib.dash2_tim_to_rgba(data.address, data.size, palette, ctypes.addressof(buffer), len(output)), "tim_to_rgba")
+    return width, height, output
@@ -50,3 +50,27 @@ void write_le_dword(FILE *f, unsigned int ledword)
 		fwrite(&c, sizeof(char), 1, f);
 	}
 }
+
+// Writes count dwords in little endian order whatever the host byte order is.
+void write_le_dwords(FILE *f, const unsigned int *ledwords, int count)
+{
+	unsigned char buf[1024];
+	int x, n;
+
+	while(count > 0)
+	{
+		n = count < 256 ? count : 256;
+
+		for(x = 0; x < n; x++)
+		{
+			buf[x * 4] = ledwords[x] & 0xff;
+			buf[x * 4 + 1] = (ledwords[x] >> 8) & 0xff;
+			buf[x * 4 + 2] = (ledwords[x] >> 16) & 0xff;
+			buf[x * 4 + 3] = ledwords[x] >> 24;
+		}
+
+		fwrite(buf, 4, n, f);
+		ledwords += n;
+		count -= n;
+	}
+}
@@ -0,0 +1,286 @@
+/*******************************************************************************
+ *
+ *  Filename:  headertbl.c
+ *
+ *  Description:  HEADER.BIN updates shared by the tools. Updates are
+ *  collected in memory and committed at once: the table is locked, mapped,
+ *  patched, checked and replaced with a rename, so tools running in
+ *  parallel on one folder never lose or tear each other's headers.
+ *  Included directly by each tool (like stats.c), headertbl.py is the
+ *  Python side of the same protocol.
+ *
+ *  Author:  happy_land
+ *  Date:  2026-10-18
+ *  Last update:  --
+ *
+ *******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define HEADER_TABLE_ENTRY_SIZE     0x30
+#define HEADER_TABLE_CHUNK_SIZE     0x800
+
+// ׸  Ϻ (offset size Ʈ) ٲٴ  ϳ
+typedef struct {
+    unsigned int index;
+    unsigned int offset;
+    unsigned int size;
+    uint8_t data[HEADER_TABLE_ENTRY_SIZE];
+} HeaderUpdate;
+
+typedef struct {
+    char path[1024];
+    HeaderUpdate *updates;
+    size_t count;
+    size_t capacity;
+} HeaderTable;
+
+void header_table_init(HeaderTable *table, const char *path) {
+    memset(table, 0, sizeof(HeaderTable));
+    snprintf(table->path, sizeof(table->path), "%s", path);
+}
+
+void header_table_free(HeaderTable *table) {
+    free(table->updates);
+    table->updates = NULL;
+    table->count = table->capacity = 0;
+}
+
+// ʵ    (commit   ǵ帮 ,  ġ   )
+int header_table_set_field(HeaderTable *table, unsigned int index, unsigned int offset, const void *data, unsigned int size) {
+    if (offset + size > HEADER_TABLE_ENTRY_SIZE) {
+        fprintf(stderr, "Invalid header field 0x%02x (%u bytes)\n", offset, size);
+        return 1;
+    }
+    if (table->count == table->capacity) {
+        size_t capacity = table->capacity ? table->capacity * 2 : 16;
+        HeaderUpdate *updates = (HeaderUpdate *)realloc(table->updates, capacity * sizeof(HeaderUpdate));
+        if (!updates) {
+            perror("Failed to allocate memory");
+            return 1;
+        }
+        table->updates = updates;
+        table->capacity = capacity;
+    }
+
+    HeaderUpdate *update = &table->updates[table->count++];
+    update->index = index;
+    update->offset = offset;
+    update->size = size;
+    memcpy(update->data, data, size);
+    return 0;
+}
+
+int header_table_set(HeaderTable *table, unsigned int index, const uint8_t *header) {
+    return header_table_set_field(table, index, 0, header, HEADER_TABLE_ENTRY_SIZE);
+}
+
+//  ׸  ī̺꿡   ִ  Ȯ
+int header_table_check(const uint8_t *entry, unsigned int index) {
+    uint32_t kind = entry[0] | (entry[1] << 8) | (entry[2] << 16) | ((uint32_t)entry[3] << 24);
+    uint32_t size = entry[4] | (entry[5] << 8) | (entry[6] << 16) | ((uint32_t)entry[7] << 24);
+    uint32_t padded = entry[8] | (entry[9] << 8) | (entry[10] << 16) | ((uint32_t)entry[11] << 24);
+
+    if (padded == 0) {
+        fprintf(stderr, "Invalid header %04u: the padded size is 0\n", index);
+        return 1;
+    }
+    // MTIM ũ   ũ̹Ƿ 
+    if (kind != 0x03 && (uint64_t)size + HEADER_TABLE_ENTRY_SIZE > (uint64_t)padded * HEADER_TABLE_CHUNK_SIZE) {
+        fprintf(stderr, "Invalid header %04u: 0x%x bytes do not fit in %u chunks\n", index, size, padded);
+        return 1;
+    }
+    return 0;
+}
+
+//   (HEADER.BIN ü rename ٲǷ  )
+#ifdef _WIN32
+typedef HANDLE HeaderLock;
+
+HeaderLock header_table_lock(const char *path) {
+    char lock_path[1100];
+    snprintf(lock_path, sizeof(lock_path), "%s.lock", path);
+    HANDLE handle = CreateFileA(lock_path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+    OVERLAPPED overlapped = {0};
+    if (!LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped)) {
+        CloseHandle(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+void header_table_unlock(HeaderLock lock) {
+    OVERLAPPED overlapped = {0};
+    UnlockFileEx(lock, 0, 1, 0, &overlapped);
+    CloseHandle(lock);
+}
+#else
+typedef int HeaderLock;
+
+HeaderLock header_table_lock(const char *path) {
+    char lock_path[1100];
+    snprintf(lock_path, sizeof(lock_path), "%s.lock", path);
+    int fd = open(lock_path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    if (flock(fd, LOCK_EX) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void header_table_unlock(HeaderLock lock) {
+    flock(lock, LOCK_UN);
+    close(lock);
+}
+#endif
+
+//  HEADER.BIN о table ũ ۷  (POSIX mmap)
+uint8_t *header_table_load(const char *path, size_t *size) {
+    uint8_t *data = NULL;
+#ifdef _WIN32
+    FILE *file = NULL;
+    errno_t err = fopen_s(&file, path, "rb");
+    if (err != 0 || file == NULL) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data = (uint8_t *)malloc(*size ? *size : 1);
+    if (data && fread(data, 1, *size, file) != *size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+#else
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+    *size = st.st_size;
+    data = (uint8_t *)malloc(*size ? *size : 1);
+    if (data && *size) {
+        void *map = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            free(data);
+            data = NULL;
+        } else {
+            memcpy(data, map, *size);
+            munmap(map, *size);
+        }
+    }
+    close(fd);
+#endif
+    return data;
+}
+
+// ӽ Ͽ  fsync  rename (߰ 絵 HEADER.BIN  Ǵ  )
+int header_table_replace(const char *path, const uint8_t *data, size_t size) {
+    char temp_path[1100];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    FILE *file = NULL;
+    errno_t err = fopen_s(&file, temp_path, "wb");
+    if (err != 0 || file == NULL) {
+        perror("Unable to write HEADER.BIN");
+        return 1;
+    }
+    int failed = fwrite(data, 1, size, file) != size || fflush(file) != 0;
+#ifndef _WIN32
+    failed = failed || fsync(fileno(file)) != 0;
+#endif
+    fclose(file);
+
+#ifdef _WIN32
+    failed = failed || !MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    failed = failed || rename(temp_path, path) != 0;
+#endif
+    if (failed) {
+        perror("Unable to replace HEADER.BIN");
+        remove(temp_path);
+        return 1;
+    }
+    return 0;
+}
+
+//      ݿ. ϳ ߸Ǹ HEADER.BIN ״ 
+int header_table_commit(HeaderTable *table) {
+    if (table->count == 0) {
+        return 0;
+    }
+
+    HeaderLock lock = header_table_lock(table->path);
+#ifdef _WIN32
+    if (lock == NULL) {
+#else
+    if (lock < 0) {
+#endif
+        fprintf(stderr, "Unable to lock %s\n", table->path);
+        return 1;
+    }
+
+    size_t size = 0;
+    uint8_t *data = header_table_load(table->path, &size);
+    int result = 0;
+    if (!data) {
+        fprintf(stderr, "Unable to read %s\n", table->path);
+        result = 1;
+    } else if (size % HEADER_TABLE_ENTRY_SIZE != 0) {
+        fprintf(stderr, "Invalid %s: 0x%zx bytes is not a multiple of 0x30\n", table->path, size);
+        result = 1;
+    }
+
+    for (size_t i = 0; result == 0 && i < table->count; i++) {
+        HeaderUpdate *update = &table->updates[i];
+        if ((size_t)update->index >= size / HEADER_TABLE_ENTRY_SIZE) {
+            fprintf(stderr, "Entry %u is not in %s\n", update->index, table->path);
+            result = 1;
+            break;
+        }
+        memcpy(data + (size_t)update->index * HEADER_TABLE_ENTRY_SIZE + update->offset, update->data, update->size);
+    }
+    for (size_t i = 0; result == 0 && i < table->count; i++) {
+        result = header_table_check(data + (size_t)table->updates[i].index * HEADER_TABLE_ENTRY_SIZE, table->updates[i].index);
+    }
+
+    if (result == 0) {
+        result = header_table_replace(table->path, data, size);
+    }
+    if (result == 0) {
+        table->count = 0;
+    }
+
+    free(data);
+    header_table_unlock(lock);
+    return result;
+}
+
+/*==============================================================*/
+/*	"headertbl.c"	End of File									*/
+/*==============================================================*/
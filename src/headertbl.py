@@ -0,0 +1,119 @@
+# -*- coding: cp949 -*-
+"""
+headertbl.py
+
+Description: Module to update HEADER.BIN safely from several tools at once.
+Author: happy_land
+Date: 26-10-18
+Last update: --
+
+Functionality:
+- Collect header and field updates in memory and commit them in one write.
+- Lock HEADER.BIN.lock while committing, check the patched headers and replace
+  HEADER.BIN with a rename (same protocol as headertbl.c in the C tools).
+"""
+
+import os
+import mmap
+import struct
+
+HEADER_SIZE = 0x30
+CHUNK_SIZE = 0x800
+
+if os.name == 'nt':
+    import msvcrt
+
+    def lock_file(fd):
+        os.lseek(fd, 0, os.SEEK_SET)
+        msvcrt.locking(fd, msvcrt.LK_LOCK, 1)
+
+    def unlock_file(fd):
+        os.lseek(fd, 0, os.SEEK_SET)
+        msvcrt.locking(fd, msvcrt.LK_UNLCK, 1)
+else:
+    import fcntl
+
+    def lock_file(fd):
+        fcntl.flock(fd, fcntl.LOCK_EX)
+
+    def unlock_file(fd):
+        fcntl.flock(fd, fcntl.LOCK_UN)
+
+def check_header(entry, index):
+    """ ׸ ī̺꿡   ִ  Ȯ"""
+    kind, size, padded = struct.unpack_from('<3I', entry, 0)
+    if padded == 0:
+        raise ValueError(f"Error: Invalid header {index:04d}: the padded size is 0")
+    # MTIM ũ   ũ̹Ƿ 
+    if kind != 0x03 and size + HEADER_SIZE > padded * CHUNK_SIZE:
+        raise ValueError(f"Error: Invalid header {index:04d}: 0x{size:x} bytes do not fit in {padded} chunks")
+
+class HeaderTable:
+    """HEADER.BIN   ξٰ commit()   ݿ
+
+    with HeaderTable(path) as table:       commitѴ.
+    """
+
+    def __init__(self, path):
+        self.path = path
+        self.updates = []  # (׸ ȣ, , )
+
+    def set(self, index, header):
+        self.set_field(index, 0, header)
+
+    def set_field(self, index, offset, data):
+        if offset + len(data) > HEADER_SIZE:
+            raise ValueError(f"Error: Invalid header field 0x{offset:02x} ({len(data)} bytes)")
+        self.updates.append((index, offset, bytes(data)))
+
+    def pack_field(self, index, offset, fmt, *values):
+        self.set_field(index, offset, struct.pack(fmt, *values))
+
+    def commit(self):
+        """ݿ HEADER.BIN  ȯ. ϳ ߸Ǹ  ״ """
+        if not self.updates:
+            return None
+
+        lock_fd = os.open(self.path + '.lock', os.O_RDWR | os.O_CREAT, 0o644)
+        try:
+            lock_file(lock_fd)
+            try:
+                with open(self.path, 'rb') as f:
+                    size = os.fstat(f.fileno()).st_size
+                    if size:
+                        with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as mapped:
+                            data = bytearray(mapped)
+                    else:
+                        data = bytearray()
+                if len(data) % HEADER_SIZE:
+                    raise ValueError(f"Error: Invalid {self.path}: 0x{len(data):x} bytes is not a multiple of 0x30")
+
+                count = len(data) // HEADER_SIZE
+                for index, offset, field in self.updates:
+                    if not 0 <= index < count:
+                        raise ValueError(f"Error: Entry {index} is not in {self.path}")
+                    start = index * HEADER_SIZE + offset
+                    data[start:start + len(field)] = field
+                for index in sorted({index for index, _, _ in self.updates}):
+                    check_header(data[index * HEADER_SIZE:(index + 1) * HEADER_SIZE], index)
+
+                temp_file = self.path + '.tmp'
+                with open(temp_file, 'wb') as f:
+                    f.write(data)
+                    f.flush()
+                    os.fsync(f.fileno())
+                os.replace(temp_file, self.path)
+            finally:
+                unlock_file(lock_fd)
+        finally:
+            os.close(lock_fd)
+
+        self.updates = []
+        return data
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, *_):
+        if exc_type is None:
+            self.commit()
@@ -0,0 +1,255 @@
+/*******************************************************************************
+ *
+ *  Filename:  libdash2.c
+ *
+ *  Description:  Shared library with the native codecs (MELT compression,
+ *  font bit planes, TIM to RGBA) behind the C ABI in libdash2.h, so the
+ *  Python tools can call them on in-memory data through dash2.py.
+ *
+ *  Author:  happy_land
+ *  Date:  2026-10-18
+ *  Last update:  --
+ *
+ *******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ̺귯  忡 Ҹ  Ƿ ڵ ī (stats.c)  
+#define MELT_STATS(...) do{ } while ( 0 )
+
+#include "melt.c"
+#include "libdash2.h"
+
+#define TIM_MAGIC           0x10
+#define TIM_HAS_CLUT        0x08
+
+static uint32_t read_u32(const uint8_t *data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static uint16_t read_u16(const uint8_t *data) {
+    return data[0] | (data[1] << 8);
+}
+
+DASH2_API int dash2_abi_version(void) {
+    return DASH2_ABI_VERSION;
+}
+
+/*==============================================================*/
+/*	MELT														*/
+/*==============================================================*/
+DASH2_API long dash2_melt_decompressed_size(const uint8_t *header) {
+    if (!header || !melt_find_variant(header)) {
+        return DASH2_E_ARGUMENT;
+    }
+    return (long)read_u32(header + 0x04);
+}
+
+DASH2_API long dash2_melt_decompress(const uint8_t *header, const uint8_t *src, size_t src_size,
+                                     uint8_t *dst, size_t dst_size) {
+    long size = dash2_melt_decompressed_size(header);
+    if (size < 0 || !src || (!dst && size)) {
+        return DASH2_E_ARGUMENT;
+    }
+    if ((size_t)size > dst_size) {
+        return DASH2_E_SPACE;
+    }
+
+    unsigned int bitfield_length = read_u16(header + 0x24);
+    memset(dst, 0, size);
+    // Է ߷Ȱų ߸    ũ⸸ŭ ä 
+    if (melt_find_variant(header)->decompress(src, src_size, bitfield_length, dst, size) < (size_t)size) {
+        return DASH2_E_DATA;
+    }
+    return size;
+}
+
+DASH2_API size_t dash2_melt_compress_bound(size_t size) {
+    //  ͷ : ̷ε size +   ǥ, Ʈʵ 2Ʈ 1Ʈ
+    return size + size / 16 + (size / melt_variant_dash2.window_size + 2) * 2 + 16;
+}
+
+DASH2_API long dash2_melt_compress(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_size,
+                                   uint16_t *bitfield_size) {
+    if ((!src && size) || !dst || !bitfield_size) {
+        return DASH2_E_ARGUMENT;
+    }
+
+    BitStream bits;
+    init_bitstream(&bits);
+
+    BitStream payload;
+    init_bitstream(&payload);
+
+    //   Ƿ DASH2  
+    const MeltVariant *variant = &melt_variant_dash2;
+    size_t pos = 0;
+    for (size_t window_end = variant->window_size; pos < size; window_end += variant->window_size) {
+        pos = variant->compress_window(src, size, pos, window_end, &bits, &payload);
+    }
+    finalize_bits(&bits);
+
+    long result = DASH2_E_SPACE;
+    if (bits.size + payload.size <= dst_size && bits.size <= 0xffff) {
+        memcpy(dst, bits.data, bits.size);
+        memcpy(dst + bits.size, payload.data, payload.size);
+        *bitfield_size = (uint16_t)bits.size;
+        result = (long)(bits.size + payload.size);
+    } else if (bits.size > 0xffff) {
+        result = DASH2_E_ARGUMENT;  //  Ʈʵ ̴ 16Ʈ
+    }
+
+    free(bits.data);
+    free(payload.data);
+    return result;
+}
+
+/*==============================================================*/
+/*	Ʈ														*/
+/*==============================================================*/
+DASH2_API long dash2_font_split(const uint8_t *src, size_t size, uint8_t *font1, uint8_t *font2) {
+    if (!src || !font1 || !font2) {
+        return DASH2_E_ARGUMENT;
+    }
+    for (size_t i = 0; i < size; i++) {
+        font1[i] = src[i] & 0x33;
+        font2[i] = (src[i] >> 2) & 0x33;
+    }
+    return (long)size;
+}
+
+DASH2_API long dash2_font_combine(const uint8_t *font1, const uint8_t *font2, size_t size, uint8_t *dst) {
+    if (!font1 || !font2 || !dst) {
+        return DASH2_E_ARGUMENT;
+    }
+    for (size_t i = 0; i < size; i++) {
+        dst[i] = (font1[i] & 0x33) | ((font2[i] & 0x33) << 2);
+    }
+    return (long)size;
+}
+
+/*==============================================================*/
+/*	TIM															*/
+/*==============================================================*/
+// TIM  ġ ã (CLUT    )
+typedef struct {
+    int bpp;
+    const uint8_t *clut;
+    int clut_colors;
+    int palettes;
+    const uint8_t *pixels;
+    int width;                      // ȼ 
+    int height;
+} TimInfo;
+
+static int parse_tim(const uint8_t *tim, size_t size, TimInfo *info) {
+    if (!tim || size < 8 || read_u32(tim) != TIM_MAGIC) {
+        return DASH2_E_ARGUMENT;
+    }
+    uint32_t flags = read_u32(tim + 4);
+    static const int BPP[4] = { 4, 8, 16, 24 };
+    memset(info, 0, sizeof(TimInfo));
+    info->bpp = BPP[flags & 3];
+    if (info->bpp == 24) {
+        return DASH2_E_ARGUMENT;
+    }
+
+    size_t offset = 8;
+    if (flags & TIM_HAS_CLUT) {
+        if (offset + 12 > size) {
+            return DASH2_E_DATA;
+        }
+        uint32_t clut_len = read_u32(tim + offset);
+        info->clut_colors = read_u16(tim + offset + 8);
+        info->palettes = read_u16(tim + offset + 10);
+        info->clut = tim + offset + 12;
+        if (clut_len < 12 || offset + clut_len > size) {
+            return DASH2_E_DATA;
+        }
+        //  ȷƮ   CLUT ª   (combbin  TIM)
+        if (info->clut_colors && (size_t)info->clut_colors * info->palettes * 2 > clut_len - 12) {
+            info->palettes = (int)((clut_len - 12) / 2 / info->clut_colors);
+        }
+        offset += clut_len;
+    }
+
+    if (offset + 12 > size) {
+        return DASH2_E_DATA;
+    }
+    int width_units = read_u16(tim + offset + 8);
+    info->height = read_u16(tim + offset + 10);
+    info->width = width_units * 16 / info->bpp;
+    info->pixels = tim + offset + 12;
+    if (offset + 12 + (size_t)width_units * 2 * info->height > size) {
+        return DASH2_E_DATA;
+    }
+    if (info->bpp < 16 && (!info->clut || info->palettes == 0)) {
+        return DASH2_E_DATA;
+    }
+    return 0;
+}
+
+DASH2_API int dash2_tim_info(const uint8_t *tim, size_t size, int *width, int *height, int *bpp, int *palettes) {
+    TimInfo info;
+    int result = parse_tim(tim, size, &info);
+    if (result != 0) {
+        return result;
+    }
+    if (width) *width = info.width;
+    if (height) *height = info.height;
+    if (bpp) *bpp = info.bpp;
+    if (palettes) *palettes = info.palettes;
+    return 0;
+}
+
+static void psx_to_rgba(uint16_t color, uint8_t *out) {
+    out[0] = (color & 31) << 3;
+    out[1] = ((color >> 5) & 31) << 3;
+    out[2] = ((color >> 10) & 31) << 3;
+    out[3] = color == 0 ? 0 : 255;
+}
+
+DASH2_API long dash2_tim_to_rgba(const uint8_t *tim, size_t size, int palette, uint8_t *dst, size_t dst_size) {
+    TimInfo info;
+    int result = parse_tim(tim, size, &info);
+    if (result != 0) {
+        return result;
+    }
+    size_t out_size = (size_t)info.width * info.height * 4;
+    if (!dst || out_size > dst_size) {
+        return DASH2_E_SPACE;
+    }
+
+    if (info.bpp == 16) {
+        for (size_t i = 0; i < (size_t)info.width * info.height; i++) {
+            psx_to_rgba(read_u16(info.pixels + i * 2), dst + i * 4);
+        }
+        return (long)out_size;
+    }
+
+    if (palette < 0 || palette >= info.palettes) {
+        return DASH2_E_ARGUMENT;
+    }
+
+    // ȷƮ   ȯ ΰ ε ã
+    uint8_t colors[256][4];
+    int count = info.clut_colors < 256 ? info.clut_colors : 256;
+    memset(colors, 0, sizeof(colors));
+    for (int i = 0; i < count; i++) {
+        psx_to_rgba(read_u16(info.clut + ((size_t)palette * info.clut_colors + i) * 2), colors[i]);
+    }
+
+    for (size_t i = 0; i < (size_t)info.width * info.height; i++) {
+        // 4bpp  Ϻ  ȼ
+        uint8_t index = info.bpp == 8 ? info.pixels[i] : (info.pixels[i / 2] >> ((i & 1) * 4)) & 0x0f;
+        memcpy(dst + i * 4, colors[index], 4);
+    }
+    return (long)out_size;
+}
+
+/*==============================================================*/
+/*	"libdash2.c"	End of File									*/
+/*==============================================================*/
@@ -0,0 +1,64 @@
+/*******************************************************************************
+ *
+ *  Filename:  libdash2.h
+ *
+ *  Description:  C ABI of libdash2 (make libdash2.so), the native codecs
+ *  for the Python tools (dash2.py). Every function works on buffers owned
+ *  by the caller and returns the number of bytes written, or a negative
+ *  DASH2_E* error code. Nothing is allocated for the caller.
+ *
+ *  Author:  happy_land
+ *  Date:  2026-10-18
+ *  Last update:  --
+ *
+ *******************************************************************************/
+
+#ifndef LIBDASH2_H
+#define LIBDASH2_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#define DASH2_API __declspec(dllexport)
+#else
+#define DASH2_API __attribute__((visibility("default")))
+#endif
+
+#define DASH2_ABI_VERSION       1
+
+#define DASH2_E_ARGUMENT        -1      // ߸  (NULL,   )
+#define DASH2_E_SPACE           -2      //  ۰ 
+#define DASH2_E_DATA            -3      // Է Ͱ ջ
+
+#define DASH2_HEADER_SIZE       0x30
+
+// ABI  (Լ ߰Ǹ ø,  Լ ǹ̴ ٲ )
+DASH2_API int dash2_abi_version(void);
+
+// MTIM  . header ī̺ ׸  (0x30Ʈ,  0x03).    
+//   ũ dash2_melt_decompressed_size()   . Է ߷Ȱų ջǸ DASH2_E_DATA
+DASH2_API long dash2_melt_decompressed_size(const uint8_t *header);
+DASH2_API long dash2_melt_decompress(const uint8_t *header, const uint8_t *src, size_t src_size,
+                                     uint8_t *dst, size_t dst_size);
+
+// MTIM  (MELTTIMTool c  ). Ʈʵ ̴ *bitfield_size 
+// ( 0x24,   ũ 0x04  )
+DASH2_API size_t dash2_melt_compress_bound(size_t size);
+DASH2_API long dash2_melt_compress(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_size,
+                                   uint16_t *bitfield_size);
+
+// Ʈ Ʈ  (FontTool split/combine): 4bpp ȼ  2Ʈ FONT1,  2Ʈ FONT2
+DASH2_API long dash2_font_split(const uint8_t *src, size_t size, uint8_t *font1, uint8_t *font2);
+DASH2_API long dash2_font_combine(const uint8_t *font1, const uint8_t *font2, size_t size, uint8_t *dst);
+
+// TIM  (4/8/16bpp) -> RGBA (ȼ 4Ʈ, )
+//  0  (tim2bmp -palettes ). palette 4/8bpp  CLUT ȣ
+DASH2_API int dash2_tim_info(const uint8_t *tim, size_t size, int *width, int *height, int *bpp, int *palettes);
+DASH2_API long dash2_tim_to_rgba(const uint8_t *tim, size_t size, int palette, uint8_t *dst, size_t dst_size);
+
+#endif
+
+/*==============================================================*/
+/*	"libdash2.h"	End of File									*/
+/*==============================================================*/
@@ -0,0 +1,230 @@
+/*******************************************************************************
+ *
+ *  Filename:  melt.c
+ *
+ *  Description:  DASH2 (MELT) codec shared by MELTTIMTool, VRAMTool and
+ *  libdash2: bit streams, the table of codec variants (meltcodec.c compiled
+ *  once per parameter set) and the lookup of a variant from an entry header.
+ *  Included directly, like endian.c, after stats.c.
+ *
+ *  Author:  happy_land
+ *  Date:  2026-10-18
+ *  Last update:  --
+ *
+ *******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//   ǥ (  )
+#define WORD_INVALID    0xffff
+
+#define DEBUG 0
+
+// ڵ ī  (stats.c).  忡  ϴ 
+// melt.c   ũη ؼ 
+#ifndef MELT_STATS
+#define MELT_STATS(...) do{ __VA_ARGS__; } while ( 0 )
+#endif
+
+#if DEBUG
+#define DEBUG_PRINT(...) do{ fprintf( stderr, __VA_ARGS__ ); } while( 0 )
+#else
+#define DEBUG_PRINT(...) do{ } while ( 0 )
+#endif
+
+/*==============================================================*/
+/*	   Լ											*/
+/*==============================================================*/
+//  Ư ¿  ̸ŭ  Ͽ  ȯ
+unsigned int unpack_data(const char *data, int offset, int length) {
+    unsigned int result = 0;
+    for (int i = 0; i < length; i++) {
+        result |= ((unsigned char)data[offset + i]) << (8 * i);
+    }
+    return result;
+}
+
+// ۿ ܾ ŷϰ   ȯ
+unsigned int pack_into_buffer(char *buffer, unsigned int destination, unsigned short word) {
+    buffer[destination] = word & 0xff;
+    buffer[destination + 1] = (word >> 8) & 0xff;
+    return destination + 2;
+}
+
+// MELT_TIM ü
+typedef struct {
+    uint32_t timEnum;               // offset: 0x00, value: 0x03
+    uint32_t decompressedSize;     // offset: 0x04
+    uint32_t paddedDataSizeNum;    // offset: 0x08
+    uint16_t paletteFramebufferX;  // offset: 0x0c
+    uint16_t paletteFramebufferY;  // offset: 0x0e
+    uint16_t paletteColors;        // offset: 0x10
+    uint16_t numberOfPalettes;     // offset: 0x12
+    uint16_t imageFramebufferX;    // offset: 0x14
+    uint16_t imageFramebufferY;    // offset: 0x16
+    uint16_t imageWidthBytes;      // offset: 0x18
+    uint16_t imageHeight;          // offset: 0x1a
+    uint16_t dummy[4];
+    uint16_t bitfieldSize;         // offset: 0x24
+    uint16_t dummy_[5];
+} MELT_TIMHeader;
+
+/*==============================================================*/
+/*	  Լ												*/
+/*==============================================================*/
+// Ʈ Ʈ ϴ ü
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    uint32_t buffer;
+    int buffer_count;
+} BitStream;
+
+// BitStream ʱȭ Լ
+void init_bitstream(BitStream *bs) {
+    bs->data = (uint8_t *)malloc(1);
+    bs->size = 0;
+    bs->capacity = 1;
+    bs->buffer = 0;
+    bs->buffer_count = 0;
+}
+
+// Ʈ ߰ϴ Լ
+void add_bits(BitStream *bs, uint32_t bits, int count) {
+    bs->buffer = (bs->buffer << count) | (bits & ((1 << count) - 1));
+    bs->buffer_count += count;
+
+    while (bs->buffer_count >= 32) {
+        bs->buffer_count -= 32;
+        if (bs->size + 4 > bs->capacity) {
+            bs->capacity *= 2;
+            bs->data = (uint8_t *)realloc(bs->data, bs->capacity);
+        }
+        uint32_t out_bits = bs->buffer >> bs->buffer_count;
+        bs->data[bs->size++] = (out_bits >> 0) & 0xFF;
+        bs->data[bs->size++] = (out_bits >> 8) & 0xFF;
+        bs->data[bs->size++] = (out_bits >> 16) & 0xFF;
+        bs->data[bs->size++] = (out_bits >> 24) & 0xFF;
+        bs->buffer &= (1 << bs->buffer_count) - 1;
+    }
+}
+
+// Ʈ  ϴ Լ
+void finalize_bits(BitStream *bs) {
+    if (bs->buffer_count > 0) {
+        bs->buffer <<= (32 - bs->buffer_count);
+        if (bs->size + 4 > bs->capacity) {
+            bs->capacity *= 2;
+            bs->data = (uint8_t *)realloc(bs->data, bs->capacity);
+        }
+        bs->data[bs->size++] = (bs->buffer >> 0) & 0xFF;
+        bs->data[bs->size++] = (bs->buffer >> 8) & 0xFF;
+        bs->data[bs->size++] = (bs->buffer >> 16) & 0xFF;
+        bs->data[bs->size++] = (bs->buffer >> 24) & 0xFF;
+        bs->buffer = 0;
+        bs->buffer_count = 0;
+    }
+}
+
+// BitStream ͸ ߰ϴ Լ
+void add_payload(BitStream *bs, const uint8_t *data, size_t size) {
+    if (bs->size + size > bs->capacity) {
+        while (bs->size + size > bs->capacity) {
+            bs->capacity *= 2;
+        }
+        bs->data = (uint8_t *)realloc(bs->data, bs->capacity);
+    }
+    memcpy(bs->data + bs->size, data, size);
+    bs->size += size;
+}
+
+/*==============================================================*/
+/*	ڵ 													*/
+/*==============================================================*/
+// Ű   ϵ ڵ (meltcodec.c).     ϸ,
+//   츶   Ƿ   Ű ˻簡 
+typedef struct {
+    const char *name;
+    uint32_t kind;                  // ׸  0x00 
+    int length_bits;                //  ܾ  ʵ Ʈ  ( )
+    size_t window_size;
+    size_t max_coded;               //  ϳ  ִ Ʈ 
+    size_t (*decompress)(const uint8_t *src, size_t src_size, unsigned int bitfield_length, uint8_t *dst, size_t dst_size);
+    size_t (*compress_window)(const uint8_t *data, size_t size, size_t pos, size_t window_end, BitStream *bits, BitStream *payload);
+} MeltVariant;
+
+#define MELT_PASTE_(name, variant)  name##_##variant
+#define MELT_PASTE(name, variant)   MELT_PASTE_(name, variant)
+#define MELT_FN(name)               MELT_PASTE(name, MELT_VARIANT)
+#define MELT_STRING_(name)          #name
+#define MELT_STRING(name)           MELT_STRING_(name)
+
+// ϸ DASH2 MTIM: 13Ʈ  (0x2000 ), 3Ʈ  (4~16Ʈ)
+#define MELT_VARIANT        dash2
+#define MELT_KIND           0x03
+#define MELT_LENGTH_BITS    3
+#include "meltcodec.c"
+
+//    ٸ   ó    ϰ ⿡ ߰
+static const MeltVariant *const melt_variants[] = {
+    &melt_variant_dash2,
+};
+
+// ׸  (0x30Ʈ)   ã.  ׸ ƴϸ NULL
+const MeltVariant *melt_find_variant(const uint8_t *header) {
+    uint32_t kind = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24);
+    for (size_t i = 0; i < sizeof(melt_variants) / sizeof(melt_variants[0]); i++) {
+        if (melt_variants[i]->kind == kind) {
+            return melt_variants[i];
+        }
+    }
+    return NULL;
+}
+
+//    Լ
+unsigned int decompress_data(const char *compressed_data, size_t compressed_size, const char *header_data, char **decompressed_data) {
+    MELT_TIMHeader header;
+    
+    //  б
+    header.timEnum = unpack_data(header_data, 0x00, 0x04);
+    const MeltVariant *variant = melt_find_variant((const uint8_t *)header_data);
+    if (!variant) {
+        printf("It is not a compressed TIM.\n");
+        exit(1);
+    }
+    
+    header.decompressedSize = unpack_data(header_data, 0x04, 0x04);
+    header.bitfieldSize = unpack_data(header_data, 0x24, 0x02);
+
+    unsigned int decompress_size = header.decompressedSize;
+    unsigned short bitfield_length = header.bitfieldSize;
+
+    if (bitfield_length == 0) {
+        fprintf(stderr, "Invalid bitfield length\n");
+        return 0;
+    }
+
+    char *buffer = (char *)calloc(decompress_size ? decompress_size : 1, 1);
+    if (!buffer) {
+        perror("Failed to allocate memory for buffer");
+        return 0;
+    }
+
+    //  ũ⸸ŭ ä ϸ (߷Ȱų ջ Է) 
+    if (variant->decompress((const uint8_t *)compressed_data, compressed_size, bitfield_length, (uint8_t *)buffer, decompress_size) < decompress_size) {
+        fprintf(stderr, "Compressed data is truncated or corrupt\n");
+        free(buffer);
+        return 0;
+    }
+
+    *decompressed_data = buffer;
+    return decompress_size;
+}
+
+/*==============================================================*/
+/*	"melt.c"	End of File											*/
+/*==============================================================*/
@@ -0,0 +1,191 @@
+/*******************************************************************************
+ *
+ *  Filename:  meltcodec.c
+ *
+ *  Description:  Body of the MELT codec, specialized at compile time.
+ *  melt.c includes it once per variant after defining MELT_VARIANT (name),
+ *  MELT_KIND (entry kind at 0x00 of the header) and MELT_LENGTH_BITS (length
+ *  field of a reference word). The window size and the match lengths follow
+ *  from them as constants, so every variant gets its own loops without
+ *  parameter checks.
+ *
+ *  Author:  happy_land
+ *  Date:  2026-10-18
+ *  Last update:  --
+ *
+ *******************************************************************************/
+
+//  ܾ (16Ʈ) =    () +  - 2 ( MELT_LENGTH_BITSƮ)
+#define V_OFFSET_BITS               (16 - MELT_LENGTH_BITS)
+#define V_WINDOW_SIZE               ((size_t)1 << V_OFFSET_BITS)
+#define V_OFFSET_MASK               (V_WINDOW_SIZE - 1)
+#define V_LENGTH_MASK               ((1u << MELT_LENGTH_BITS) - 1)
+//  ʵ尡  1̸ ¿  WORD_INVALID ǹǷ    
+#define V_MAX_CODED                 ((size_t)2 << MELT_LENGTH_BITS)
+#define V_MAX_UNCODED               ((size_t)2 << 1)
+
+/*==============================================================*/
+/*	 													*/
+/*==============================================================*/
+//   (src: Ʈʵ + ̷ε,  ȣ   dst )
+//  Ʈ  ȯϰ, Ʈʵ尡 src  0.    ġ Ű  
+// ű⼭ ߹Ƿ ջ Է dst_size  
+static size_t MELT_FN(melt_decompress)(const uint8_t *src, size_t src_size, unsigned int bitfield_length, uint8_t *dst, size_t dst_size) {
+    if (bitfield_length == 0 || bitfield_length > src_size) {
+        return 0;
+    }
+
+    // Ʈʵ ( ): 0 = ͷ, 1 = 
+    // 32Ʈ Ʋ    Ʈ  (src   ʵ Ʈ  а, Ѵ κ 0)
+    size_t destination = 0, window = 0, payload_offset = bitfield_length;
+    for (size_t i = 0; i < (size_t)bitfield_length * 8; i++) {
+        if (destination >= dst_size || payload_offset >= src_size) {
+            break;
+        }
+        size_t bit_index = 31 - i % 32;
+        size_t bit_byte = i / 32 * 4 + bit_index / 8;
+        int bit = bit_byte < src_size ? (src[bit_byte] >> (bit_index % 8)) & 1 : 0;
+
+        // Ȧ ũ   ͷ 1Ʈ
+        uint16_t word = src[payload_offset] | (payload_offset + 1 < src_size ? src[payload_offset + 1] << 8 : 0);
+        if (!bit) {
+            dst[destination++] = word & 0xff;
+            if (destination < dst_size) {
+                dst[destination++] = word >> 8;
+            }
+            MELT_STATS(stats.literals++);
+            DEBUG_PRINT("Literal word: 0x%04x\n", word);
+        } else if (word == WORD_INVALID) {
+            window += V_WINDOW_SIZE;
+            MELT_STATS(stats.window_advances++);
+            DEBUG_PRINT("Window incremented: 0x%04x\n", (unsigned int)window);
+        } else {
+            size_t source_offset = window + ((word >> MELT_LENGTH_BITS) & V_OFFSET_MASK);
+            unsigned short length = (word & V_LENGTH_MASK) + 2;
+            if (source_offset >= destination) {
+                DEBUG_PRINT("Invalid reference: 0x%04x at 0x%04x\n", (unsigned int)source_offset, (unsigned int)destination);
+                break;
+            }
+            MELT_STATS(stats_match(length * 2));
+            DEBUG_PRINT("Copying from offset: 0x%04x, length: 0x%04x\n", (unsigned int)source_offset, length);
+            //  ڵó 2Ʈ а  (   ġ 0 )
+            while (length > 0 && destination < dst_size) {
+                uint8_t low = source_offset < destination ? dst[source_offset] : 0;
+                uint8_t high = source_offset + 1 < destination ? dst[source_offset + 1] : 0;
+                dst[destination++] = low;
+                if (destination < dst_size) {
+                    dst[destination++] = high;
+                }
+                source_offset += 2;
+                length--;
+            }
+        }
+        payload_offset += 2;
+    }
+    return destination;
+}
+
+/*==============================================================*/
+/*															*/
+/*==============================================================*/
+// ̵ 츦 Ͽ   ġ ã Լ
+//     V_MAX_CODED̹Ƿ    
+static void MELT_FN(find_match)(const uint8_t *data, size_t pos, size_t len, size_t *match_pos, size_t *match_len) {
+    *match_pos = 0;
+    *match_len = 0;
+    if (pos >= len || len - pos < V_MAX_UNCODED) {
+        return;
+    }
+
+    size_t search_pos = pos & ~V_OFFSET_MASK;
+    size_t length = len - pos < V_MAX_CODED ? len - pos : V_MAX_CODED;
+    size_t max_match_length = 0;
+    size_t max_match_position = 0;
+    MELT_STATS(stats.probes += pos - search_pos);
+
+    for (size_t i = search_pos; i < pos; ++i) {
+        //     ġ (pos)   
+        size_t limit = pos - i < length ? pos - i : length;
+        size_t current_match_length = 0;
+        while (current_match_length < limit && data[i + current_match_length] == data[pos + current_match_length]) {
+            current_match_length++;
+        }
+
+        if (current_match_length > max_match_length) {
+            max_match_length = current_match_length;
+            max_match_position = i;
+        }
+    }
+
+    if (max_match_length < V_MAX_UNCODED) {
+        return;
+    }
+
+    *match_pos = max_match_position;
+    *match_len = max_match_length;
+}
+
+//  ϳ  (pos window_end Ѿ   ǥø  ),  ġ ȯ
+//   ۺ  ų  Ƿ 츶  
+static size_t MELT_FN(compress_window)(const uint8_t *data, size_t size, size_t pos, size_t window_end, BitStream *bits, BitStream *payload) {
+    while (pos < size) {
+        size_t match_pos, match_len;
+        MELT_FN(find_match)(data, pos, size, &match_pos, &match_len);
+
+        DEBUG_PRINT("Position: 0x%04x, Match offset: 0x%04x, Match length: 0x%04x\n", pos, match_pos, match_len);
+
+        if (match_len >= V_MAX_UNCODED && match_len % 2 == 0) {
+            add_bits(bits, 1, 1);
+            uint16_t offset = match_pos & V_OFFSET_MASK;
+            uint16_t length = (match_len / 2) - 2;
+            uint16_t word = (offset << MELT_LENGTH_BITS) | (length & V_LENGTH_MASK);
+            add_payload(payload, (uint8_t *)&word, 2);
+            pos += match_len;
+            MELT_STATS(stats_match(match_len));
+        } else {
+            add_bits(bits, 0, 1);
+            MELT_STATS(stats.literals++);
+            if (pos + 1 < size) {
+                uint16_t word = data[pos] | (data[pos + 1] << 8);
+                add_payload(payload, (uint8_t *)&word, 2);
+                pos += 2;
+            } else {
+                add_payload(payload, &data[pos], 1);
+                pos++;
+            }
+        }
+
+        if (pos >= window_end) {
+            add_bits(bits, 1, 1);
+            uint16_t end_marker = WORD_INVALID;
+            add_payload(payload, (uint8_t *)&end_marker, 2);
+            MELT_STATS(stats.window_advances++);
+            break;
+        }
+    }
+    return pos;
+}
+
+const MeltVariant MELT_FN(melt_variant) = {
+    MELT_STRING(MELT_VARIANT),
+    MELT_KIND,
+    MELT_LENGTH_BITS,
+    V_WINDOW_SIZE,
+    V_MAX_CODED,
+    MELT_FN(melt_decompress),
+    MELT_FN(compress_window),
+};
+
+#undef V_OFFSET_BITS
+#undef V_WINDOW_SIZE
+#undef V_OFFSET_MASK
+#undef V_LENGTH_MASK
+#undef V_MAX_CODED
+#undef V_MAX_UNCODED
+#undef MELT_VARIANT
+#undef MELT_KIND
+#undef MELT_LENGTH_BITS
+
+/*==============================================================*/
+/*	"meltcodec.c"	End of File									*/
+/*==============================================================*/
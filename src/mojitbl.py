@@ -0,0 +1,157 @@
+# -*- coding: cp949 -*-
+"""
+mojitbl.py
+
+Description: Script to compile Moji.tbl into a C header.
+Author: happy_land
+Date: 26-10-18
+Last update: --
+
+Functionality:
+- Decode table: arrays indexed directly by the 1-byte code (0x00-0xE9)
+  and the 2-byte code (0xF8xx-0xFAxx).
+- Encode table: minimal perfect hash from Unicode code point to code bytes.
+"""
+
+import sys
+
+MASK32 = 0xffffffff
+MAX_DISPLACEMENT = 0xffff
+
+# MSGTool.c moji_hash() ƾ 
+def moji_hash(x, seed):
+    x = (x ^ seed) & MASK32
+    x ^= x >> 16
+    x = (x * 0x85ebca6b) & MASK32
+    x ^= x >> 13
+    x = (x * 0xc2b2ae35) & MASK32
+    x ^= x >> 16
+    return x
+
+#  ̺ б (txt2msg.py   ڴ  ׸ )
+def load_moji_table(file_path):
+    decode_1 = {}
+    decode_2 = {}
+    encode = {}
+    with open(file_path, 'r', encoding='utf-8') as f:
+        for line in f:
+            line = line.rstrip('\r\n')
+            if '=' not in line:
+                continue
+            key, value = line.split('=', 1)
+            key = key.strip()
+            try:
+                code = int(key, 16)
+            except ValueError:
+                print(f"Invalid value: '{key}' in line: '{line}'")
+                continue
+
+            if len(key) == 2 and code < 0xEA:
+                decode_1[code] = value
+            elif len(key) == 4 and 0xF800 <= code < 0xFB00:
+                decode_2[code] = value
+
+            if len(key) in (2, 4) and len(value) == 1:
+                encode[ord(value)] = (code, len(key) // 2)
+    return decode_1, decode_2, encode
+
+#  ؽ  (hash and displace)
+def build_perfect_hash(keys):
+    size = len(keys)
+    bucket_count = max(1, size // 4)
+
+    while True:
+        buckets = [[] for _ in range(bucket_count)]
+        for key in keys:
+            buckets[moji_hash(key, 0) % bucket_count].append(key)
+
+        slots = [None] * size
+        displacements = [0] * bucket_count
+        success = True
+
+        # Ű  Ŷ  ڸ ã
+        for bucket_index in sorted(range(bucket_count), key=lambda i: -len(buckets[i])):
+            bucket = buckets[bucket_index]
+            if not bucket:
+                continue
+            for displacement in range(1, MAX_DISPLACEMENT + 1):
+                positions = [moji_hash(key, displacement) % size for key in bucket]
+                if len(set(positions)) == len(positions) and all(slots[p] is None for p in positions):
+                    for key, p in zip(bucket, positions):
+                        slots[p] = key
+                    displacements[bucket_index] = displacement
+                    break
+            else:
+                success = False
+                break
+
+        if success:
+            return displacements, slots
+        bucket_count += bucket_count // 4 + 1
+
+def c_string(value):
+    if value is None:
+        return 'NULL'
+    return '"' + ''.join(f'\\x{b:02x}' for b in value.encode('utf-8')) + '"'
+
+def write_header(output_file, decode_1, decode_2, encode):
+    keys = sorted(encode)
+    displacements, slots = build_perfect_hash(keys)
+
+    lines = []
+    lines.append('/* Generated by mojitbl.py from Moji.tbl. Do not edit. */')
+    lines.append('')
+    lines.append('#ifndef MOJI_TBL_H')
+    lines.append('#define MOJI_TBL_H')
+    lines.append('')
+    lines.append('#include <stdint.h>')
+    lines.append('')
+
+    # ڵ: 1Ʈ  (0x00 - 0xE9)
+    lines.append('static const char *const MOJI_DECODE_1[0xEA] = {')
+    for code in range(0xEA):
+        lines.append(f'    {c_string(decode_1.get(code))},')
+    lines.append('};')
+    lines.append('')
+
+    # ڵ: 2Ʈ  (0xF8xx - 0xFAxx)
+    lines.append('static const char *const MOJI_DECODE_2[3][0x100] = {')
+    for high in range(3):
+        lines.append('    {')
+        for low in range(0x100):
+            lines.append(f'        {c_string(decode_2.get(((0xF8 + high) << 8) | low))},')
+        lines.append('    },')
+    lines.append('};')
+    lines.append('')
+
+    # ڵ: ڵ Ʈ -> ڵ
+    lines.append(f'#define MOJI_HASH_SIZE          {len(slots)}')
+    lines.append(f'#define MOJI_HASH_BUCKET_COUNT  {len(displacements)}')
+    lines.append('')
+    lines.append('static const uint16_t MOJI_HASH_DISPLACEMENTS[MOJI_HASH_BUCKET_COUNT] = {')
+    for i in range(0, len(displacements), 16):
+        lines.append('    ' + ', '.join(str(d) for d in displacements[i:i + 16]) + ',')
+    lines.append('};')
+    lines.append('')
+    lines.append('// { code point, code, code length }')
+    lines.append('static const struct { uint32_t code_point; uint16_t code; uint8_t length; } MOJI_HASH_SLOTS[MOJI_HASH_SIZE] = {')
+    for key in slots:
+        code, length = encode[key]
+        lines.append(f'    {{ 0x{key:05x}, 0x{code:04x}, {length} }},')
+    lines.append('};')
+    lines.append('')
+    lines.append('#endif')
+
+    with open(output_file, 'w', encoding='utf-8', newline='\n') as f:
+        f.write('\n'.join(lines) + '\n')
+
+def main():
+    if len(sys.argv) != 3:
+        print("Usage: python mojitbl.py <Moji.tbl> <output_header>")
+        sys.exit(1)
+
+    decode_1, decode_2, encode = load_moji_table(sys.argv[1])
+    write_header(sys.argv[2], decode_1, decode_2, encode)
+
+if __name__ == '__main__':
+    main()
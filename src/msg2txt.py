@@ -131,7 +131,7 @@ def load_moji_table(file_path):
     with open(file_path, 'r', encoding='utf-8') as file:
         for line in file:
             if '=' in line:
-                key, value = line.strip().split('=')
+                key, value = line.rstrip('\r\n').split('=')
                 key_bytes = bytes.fromhex(key)
                 moji_dict[key_bytes] = value
     return moji_dict
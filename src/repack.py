@@ -0,0 +1,422 @@
+# -*- coding: cp949 -*-
+"""
+repack.py
+
+Description: Incremental parallel rebuild of the BIN archives from the edited source files.
+Author: happy_land
+Date: 26-10-18
+Last update: --
+
+Functionality:
+- Model every folder extracted with combbin.py as a dependency graph:
+  source files -> encoded entries -> HEADER.BIN -> archive.
+- TXT -> MSG (MSGTool e), PIX -> MTIM (libdash2, or MELTTIMTool c), FONT1.TIM + FONT2.TIM -> font PIX (FontTool combine),
+  TIM and uncompressed PIX are copied as they are.
+- Detect stale nodes with content hashes (files are hashed again only when their size or time changed)
+  and run only the dirty part of the graph on a work-stealing thread pool.
+"""
+
+import os
+import sys
+import glob
+import json
+import time
+import shutil
+import struct
+import hashlib
+import threading
+import subprocess
+import collections
+
+import combbin
+import headertbl
+import txt2msg
+import dash2
+
+HEADER_SIZE = 0x30
+KIND_MTIM = 0x03
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+EXE_SUFFIX = '.exe' if os.name == 'nt' else ''
+
+STATE_FILE = '.repack.json'
+STATE_VERSION = 1
+FONT_FILES = ('FONT1.TIM', 'FONT2.TIM')
+
+def tool_path(name):
+    return os.path.join(SCRIPT_DIR, name + EXE_SUFFIX)
+
+def run_tool(*args):
+    subprocess.run(args, check=True, stdout=subprocess.DEVNULL)
+
+def write_bytes(path, data):
+    with open(path, 'wb') as f:
+        f.write(data)
+
+def replace_output(output_file, write):
+    """write(ӽ )      output_file ü
+
+    combbin -X   ׸ .objects ٸ ī̺  ׸ ϵ帵ũǾ Ƿ
+    ڸ    Բ ٲ.
+    """
+    temp_file = output_file + '.tmp'
+    try:
+        write(temp_file)
+        os.replace(temp_file, output_file)
+    finally:
+        if os.path.exists(temp_file):
+            os.remove(temp_file)
+
+class FileHashes:
+    """  ؽ. ũ  ð ״    ؽø ٽ """
+
+    def __init__(self, cache):
+        self.cache = cache  #  -> [ ð, ũ, ؽ]
+        self.lock = threading.Lock()
+
+    def get(self, path):
+        try:
+            st = os.stat(path)
+        except OSError:
+            return None
+        with self.lock:
+            cached = self.cache.get(path)
+        if cached and cached[0] == st.st_mtime_ns and cached[1] == st.st_size:
+            return cached[2]
+
+        digest = hashlib.blake2b(digest_size=16)
+        with open(path, 'rb') as f:
+            for chunk in iter(lambda: f.read(0x100000), b''):
+                digest.update(chunk)
+        value = digest.hexdigest()
+        with self.lock:
+            self.cache[path] = [st.st_mtime_ns, st.st_size, value]
+        return value
+
+class Node:
+    """׷ ۾ ϳ. inputs() ؽð     ״θ ǳʶ"""
+
+    def __init__(self, key, inputs, outputs, action, deps=(), check=False):
+        self.key = key
+        self.inputs = inputs        # Է   ִ Լ ( ۾  ڿ ȣ)
+        self.outputs = outputs
+        self.action = action
+        self.deps = list(deps)
+        self.check = check          # ؽ  Ź ϰ,  ٲ True ȯϴ ۾
+        self.dependents = []
+        self.remaining = len(self.deps)
+        self.status = None          # 'clean', 'run', 'failed', 'skipped'
+        self.seconds = 0.0
+        self.chain = 0.0            #  ۾ ̾    ð ( ۾ )
+
+class WorkStealingPool:
+    """۾ڸ  ΰ ڱ  ڿ(LIFO), ٸ ۾  տ    Ǯ
+
+     ۾ Ǯ  ۾  ۾  Ƿ   罽  忡 ̾ ,
+    Ѱ ۾ڴ   ٸ ۾ . ۾ ü ܺ α׷̳ libdash2
+    GIL      ϳ ȣѴ.
+    """
+
+    def __init__(self, workers):
+        self.queues = [collections.deque() for _ in range(workers)]
+        self.cond = threading.Condition()
+        self.pending = 0
+        self.next_queue = 0
+        self.local = threading.local()
+
+    def submit(self, task):
+        with self.cond:
+            worker = getattr(self.local, 'index', None)
+            if worker is None:
+                worker = self.next_queue
+                self.next_queue = (self.next_queue + 1) % len(self.queues)
+            self.queues[worker].append(task)
+            self.pending += 1
+            self.cond.notify()
+
+    def take(self, index):
+        if self.queues[index]:
+            return self.queues[index].pop()
+        for offset in range(1, len(self.queues)):
+            queue = self.queues[(index + offset) % len(self.queues)]
+            if queue:
+                return queue.popleft()
+        return None
+
+    def worker(self, index):
+        self.local.index = index
+        while True:
+            with self.cond:
+                task = self.take(index)
+                while task is None and self.pending:
+                    self.cond.wait()
+                    task = self.take(index)
+                if task is None:
+                    return
+            try:
+                task()
+            finally:
+                with self.cond:
+                    self.pending -= 1
+                    if not self.pending:
+                        self.cond.notify_all()
+
+    def run(self):
+        """submit() ۾  ۾ ߰ ۾    """
+        threads = [threading.Thread(target=self.worker, args=(index,)) for index in range(len(self.queues))]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+class Repack:
+    def __init__(self, project_folder, source_folder, archive_folder, jobs=None):
+        self.project_folder = os.path.abspath(project_folder)
+        self.source_folder = os.path.abspath(source_folder)
+        self.archive_folder = os.path.abspath(archive_folder)
+        self.jobs = jobs or os.cpu_count() or 1
+        self.use_dash2 = dash2.available()
+        self.use_msgtool = os.path.exists(tool_path('MSGTool'))
+
+        self.state_file = os.path.join(self.project_folder, STATE_FILE)
+        state = {}
+        if os.path.exists(self.state_file):
+            with open(self.state_file, 'r', encoding='utf-8') as f:
+                state = json.load(f)
+        if state.get('version') != STATE_VERSION:
+            state = {}
+        self.hashes = FileHashes(state.get('files', {}))
+        self.records = state.get('nodes', {})  # ۾ Ű -> {'signature', 'outputs', 'patch'}
+        self.lock = threading.Lock()
+        self.nodes = []
+
+    def save_state(self):
+        state = {'version': STATE_VERSION, 'files': self.hashes.cache, 'nodes': self.records}
+        temp_file = self.state_file + '.tmp'
+        with open(temp_file, 'w', encoding='utf-8') as f:
+            json.dump(state, f)
+        os.replace(temp_file, self.state_file)
+
+    # ׷ 
+    def add_node(self, *args, **kwargs):
+        node = Node(*args, **kwargs)
+        for dep in node.deps:
+            dep.dependents.append(node)
+        self.nodes.append(node)
+        return node
+
+    def build_graph(self):
+        for header_file in sorted(glob.glob(os.path.join(self.project_folder, '*', 'HEADER.BIN'))):
+            folder = os.path.dirname(header_file)
+            name = os.path.basename(folder)
+            with open(header_file, 'rb') as f:
+                header_data = f.read()
+
+            entries = []
+            source_dir = os.path.join(self.source_folder, name)
+            for source_file in sorted(glob.glob(os.path.join(source_dir, '[0-9][0-9][0-9][0-9]_' + name + '.*'))):
+                node = self.entry_node(folder, name, header_data, source_file)
+                if node:
+                    entries.append(node)
+            fonts = [os.path.join(source_dir, font) for font in FONT_FILES]
+            if all(os.path.exists(font) for font in fonts):
+                node = self.font_node(folder, name, fonts)
+                if node:
+                    entries.append(node)
+
+            header_node = self.add_node(f'{name}/HEADER.BIN', lambda: [], [header_file],
+                                        lambda folder=folder: self.apply_patches(folder), entries, check=True)
+            # ҽ  ׸( ģ TIM ) տ Ƿ   ׸ Է
+            archive_file = os.path.join(self.archive_folder, name + '.BIN')
+            self.add_node(f'{name}.BIN', lambda folder=folder: self.archive_inputs(folder), [archive_file],
+                          lambda folder=folder: combbin.combine_files(folder, self.archive_folder), [header_node])
+
+        # ҽ  ׸   (ٽ      ʵ)
+        keys = {node.key for node in self.nodes}
+        self.records = {key: record for key, record in self.records.items() if key in keys}
+
+    def entry_node(self, folder, name, header_data, source_file):
+        source_name = os.path.basename(source_file)
+        index = int(source_name[:4])
+        extension = os.path.splitext(source_name)[1].upper()
+        header = header_data[index * HEADER_SIZE:(index + 1) * HEADER_SIZE]
+        if len(header) < HEADER_SIZE:
+            print(f"Skipping {name}/{source_name}: entry {index} is not in HEADER.BIN")
+            return None
+        kind = struct.unpack_from('<I', header, 0)[0]
+        base = os.path.join(folder, f'{index:04d}_{name}')
+
+        if extension == '.TXT':
+            output_file, action = base + '.MSG', self.encode_txt
+        elif extension == '.PIX' and kind == KIND_MTIM:
+            output_file, action = base + '.MTIM', self.compress_pix
+        elif extension in ('.TIM', '.PIX'):
+            output_file, action = base + extension, self.copy_entry
+        else:
+            return None
+
+        if not self.can_replace(output_file, f'{name}/{source_name}'):
+            return None
+        return self.add_node(f'{name}/{os.path.basename(output_file)}', lambda: [source_file], [output_file],
+                             lambda: action(source_file, output_file, folder, index))
+
+    def can_replace(self, output_file, source):
+        """combbin -c ȣ  ϳ ־ ϹǷ Ȯڰ ٸ ׸ ٲ  """
+        existing = glob.glob(glob.escape(os.path.splitext(output_file)[0]) + '.*')
+        if existing and output_file not in existing:
+            print(f"Skipping {source}: the entry is {os.path.basename(existing[0])}")
+            return False
+        return True
+
+    def font_node(self, folder, name, fonts):
+        output_file = os.path.join(folder, f'0000_{name}.PIX')
+        if not self.can_replace(output_file, f'{name}/{FONT_FILES[0]}'):
+            return None
+
+        def combine():
+            replace_output(output_file, lambda temp_file: run_tool(tool_path('FontTool'), 'combine', fonts[0], fonts[1], temp_file))
+            return None
+
+        return self.add_node(f'{name}/{os.path.basename(output_file)}', lambda: fonts, [output_file], combine)
+
+    def archive_inputs(self, folder):
+        name = os.path.basename(folder)
+        files = glob.glob(os.path.join(folder, '[0-9][0-9][0-9][0-9]_' + name + '.*'))
+        return [os.path.join(folder, 'HEADER.BIN')] + sorted(files)
+
+    # ۾ (HEADER.BIN ݿ ׸  ȯ)
+    def encode_txt(self, txt_file, msg_file, folder, index):
+        if self.use_msgtool:
+            # MSGTool e TXT  MSG Ƿ Ʈ  ӽ Ϸ ű  ü
+            run_tool(tool_path('MSGTool'), 'e', txt_file)
+            replace_output(msg_file, lambda temp_file: shutil.move(os.path.splitext(txt_file)[0] + '.MSG', temp_file))
+        else:
+            binary_data = txt2msg.txt_to_bin(txt_file)
+            replace_output(msg_file, lambda temp_file: write_bytes(temp_file, binary_data))
+
+        size = os.path.getsize(msg_file)
+        header = bytearray(self.header_entry(folder, index))
+        padded_size = combbin.pad_to_multiple_of(HEADER_SIZE + size, combbin.CHUNK_SIZE)
+        struct.pack_into('<II', header, 0x04, size, padded_size // combbin.CHUNK_SIZE)
+        return header
+
+    def compress_pix(self, pix_file, mtim_file, folder, index):
+        if not self.use_dash2:
+            # MELTTIMTool HEADER.BIN  ϹǷ   ״ 
+            # (HEADER.BIN   ãǷ ӽ ϵ   )
+            replace_output(mtim_file, lambda temp_file: run_tool(tool_path('MELTTIMTool'), 'c', pix_file, temp_file))
+            return self.header_entry(folder, index)
+
+        with open(pix_file, 'rb') as f:
+            data = f.read()
+        compressed, header = dash2.compress(data, self.header_entry(folder, index))
+        replace_output(mtim_file, lambda temp_file: write_bytes(temp_file, compressed))
+        return header
+
+    def copy_entry(self, source_file, output_file, folder, index):
+        replace_output(output_file, lambda temp_file: shutil.copyfile(source_file, temp_file))
+        return None
+
+    def header_entry(self, folder, index):
+        with open(os.path.join(folder, 'HEADER.BIN'), 'rb') as f:
+            f.seek(index * HEADER_SIZE)
+            return f.read(HEADER_SIZE)
+
+    def apply_patches(self, folder):
+        """ ׸ ۾     HEADER.BIN ٸ ͸   ݿ"""
+        name = os.path.basename(folder)
+        header_file = os.path.join(folder, 'HEADER.BIN')
+        with open(header_file, 'rb') as f:
+            header_data = f.read()
+
+        table = headertbl.HeaderTable(header_file)
+        prefix = name + '/'
+        for key, record in self.records.items():
+            patch = record.get('patch')
+            if not key.startswith(prefix) or patch is None:
+                continue
+            index = int(key[len(prefix):len(prefix) + 4])
+            patch = bytes.fromhex(patch)
+            if header_data[index * HEADER_SIZE:(index + 1) * HEADER_SIZE] != patch:
+                table.set(index, patch)
+        return table.commit() is not None
+
+    # 
+    def signature(self, node):
+        digest = hashlib.blake2b(node.key.encode('utf-8'), digest_size=16)
+        for path in node.inputs():
+            value = self.hashes.get(path)
+            if value is None:
+                raise FileNotFoundError(f"Error: {path} does not exist")
+            digest.update(f'{os.path.basename(path)}:{value};'.encode('utf-8'))
+        return digest.hexdigest()
+
+    def is_clean(self, node, signature):
+        with self.lock:
+            record = self.records.get(node.key)
+        if record is None or record['signature'] != signature:
+            return False
+        #   ưų  ٽ 
+        return all(self.hashes.get(path) == value for path, value in record['outputs'].items())
+
+    def execute(self, node, pool):
+        if any(dep.status in ('failed', 'skipped') for dep in node.deps):
+            node.status = 'skipped'
+        else:
+            start = time.perf_counter()
+            try:
+                if node.check:
+                    node.status = 'run' if node.action() else 'clean'
+                elif self.is_clean(node, signature := self.signature(node)):
+                    node.status = 'clean'
+                else:
+                    patch = node.action()
+                    record = {'signature': signature,
+                              'outputs': {path: self.hashes.get(path) for path in node.outputs}}
+                    if patch is not None:
+                        record['patch'] = bytes(patch).hex()
+                    with self.lock:
+                        self.records[node.key] = record
+                    node.status = 'run'
+            except Exception as e:
+                node.status = 'failed'
+                print(f"Error: {node.key}: {e}")
+            node.seconds = time.perf_counter() - start if node.status == 'run' else 0.0
+            node.chain = node.seconds + max((dep.chain for dep in node.deps), default=0.0)
+            if node.status == 'run':
+                print(f"{node.key}: {node.seconds * 1000:.1f} ms")
+
+        for dependent in node.dependents:
+            with self.lock:
+                dependent.remaining -= 1
+                ready = dependent.remaining == 0
+            if ready:
+                pool.submit(lambda dependent=dependent: self.execute(dependent, pool))
+
+    def run(self):
+        self.build_graph()
+        if not self.nodes:
+            print(f"No folders with HEADER.BIN found in {self.project_folder}")
+            return 1
+
+        start = time.perf_counter()
+        pool = WorkStealingPool(self.jobs)
+        for node in self.nodes:
+            if not node.deps:
+                pool.submit(lambda node=node: self.execute(node, pool))
+        pool.run()
+        self.save_state()
+
+        counts = collections.Counter(node.status for node in self.nodes)
+        critical_path = max(node.chain for node in self.nodes)
+        print(f"{counts['run']} of {len(self.nodes)} nodes run, {counts['failed']} failed, {counts['skipped']} skipped "
+              f"({time.perf_counter() - start:.3f} s, longest dirty chain {critical_path:.3f} s, {self.jobs} threads)")
+        return 1 if counts['failed'] else 0
+
+if __name__ == '__main__':
+    if len(sys.argv) not in (4, 5):
+        print("Usage: python repack.py <project_folder> <source_folder> <archive_folder> [<jobs>]")
+        sys.exit(1)
+
+    jobs = int(sys.argv[4]) if len(sys.argv) == 5 else None
+    sys.exit(Repack(sys.argv[1], sys.argv[2], sys.argv[3], jobs).run())
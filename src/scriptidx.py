@@ -0,0 +1,320 @@
+# -*- coding: cp949 -*-
+"""
+scriptidx.py
+
+Description: Script to search the game script through an inverted index.
+Author: happy_land
+Date: 26-10-18
+Last update: --
+
+Functionality:
+- Build an index from a script database made by MSGTool (b mode).
+- Search dialogue phrases (character n-grams) and control codes (tokens).
+- Update the index for a single changed MSG without rebuilding it.
+"""
+
+import os
+import re
+import sys
+import mmap
+import json
+import time
+import struct
+import bisect
+import hashlib
+
+import msg2txt
+
+SCRIPT_DB_MAGIC = b'D2SC'
+INDEX_MAGIC = b'D2IX'
+INDEX_VERSION = 2
+INDEX_HEADER = struct.Struct('<4s11I')
+DOC = struct.Struct('<4H2I')     # ī̺, ׸, , , ؽƮ ġ, ؽƮ 
+TERM = struct.Struct('<2I')      #  ġ,   (Ű  Q 迭 )
+DB_RECORD = struct.Struct('<4H4I')
+
+# Ű  2Ʈ  
+KEY_UNIGRAM = 1 << 62
+KEY_BIGRAM = 2 << 62
+KEY_TOKEN = 3 << 62
+TOKEN_MASK = (1 << 62) - 1
+
+#  ڵ  (: voiceload, item_name(51,95), _fb04(%H50290))
+CONTROL_CODE = re.compile(r'^([A-Za-z_][A-Za-z0-9_]*)(\(.*\))?$')
+SEPARATORS = re.compile(r'[\n\t]+')
+WHITESPACE = re.compile(r'\s+')
+
+def delta_path(index_file):
+    return index_file + '.delta'
+
+# 縦 (ȭ,  ڵ ) 
+def split_message(text):
+    dialogue = []
+    tokens = []
+    for part in SEPARATORS.split(text):
+        match = CONTROL_CODE.match(part)
+        if match:
+            tokens.append(match.group(1))
+        elif part:
+            dialogue.append(part)
+    return WHITESPACE.sub('', ''.join(dialogue)), tokens
+
+def token_key(name):
+    digest = hashlib.blake2b(name.encode('utf-8'), digest_size=8).digest()
+    return KEY_TOKEN | (struct.unpack('<Q', digest)[0] & TOKEN_MASK)
+
+def dialogue_keys(dialogue):
+    keys = {KEY_UNIGRAM | ord(c) for c in dialogue}
+    keys.update(KEY_BIGRAM | (ord(a) << 21) | ord(b) for a, b in zip(dialogue, dialogue[1:]))
+    return keys
+
+def message_keys(text):
+    dialogue, tokens = split_message(text)
+    keys = dialogue_keys(dialogue)
+    keys.update(token_key(name) for name in tokens)
+    return keys
+
+# ˻ ϳ (Ű , Ȯ Լ) ȯ
+def parse_query_term(term):
+    match = CONTROL_CODE.match(term)
+    if match:
+        name = match.group(1)
+        return [token_key(name)], lambda dialogue, tokens: name in tokens
+
+    phrase = WHITESPACE.sub('', term)
+    if len(phrase) == 1:
+        keys = [KEY_UNIGRAM | ord(phrase)]
+    else:
+        keys = sorted(dialogue_keys(phrase) - {KEY_UNIGRAM | ord(c) for c in phrase})
+    return keys, lambda dialogue, tokens: phrase in dialogue
+
+def read_script_db(db_file):
+    with open(db_file, 'rb') as f:
+        data = f.read()
+
+    magic, version, archive_count, record_count, names_offset, records_offset, text_offset, text_size = struct.unpack_from('<4s7I', data, 0)
+    if magic != SCRIPT_DB_MAGIC or version != 1:
+        print(f"{db_file} is not a script database.")
+        sys.exit(1)
+
+    names = [name.decode('utf-8') for name in data[names_offset:records_offset].split(b'\0')[:archive_count]]
+    messages = []
+    for i in range(record_count):
+        archive, entry, message, _, _, _, offset, length = DB_RECORD.unpack_from(data, records_offset + i * DB_RECORD.size)
+        text = data[text_offset + offset:text_offset + offset + length].decode('utf-8')
+        messages.append((archive, entry, message, text))
+    return names, messages
+
+# messages: (ī̺ ȣ, ׸, , ؽƮ) 
+def write_index(index_file, names, messages):
+    messages = sorted(messages, key=lambda m: m[:3])
+
+    postings = {}
+    text = bytearray()
+    docs = bytearray()
+    for doc_id, (archive, entry, message, message_text) in enumerate(messages):
+        encoded = message_text.encode('utf-8')
+        docs += DOC.pack(archive, entry, message, 0, len(text), len(encoded))
+        text += encoded
+        for key in message_keys(message_text):
+            postings.setdefault(key, []).append(doc_id)
+
+    names_blob = b''.join(name.encode('utf-8') + b'\0' for name in names)
+    names_blob += b'\0' * (-len(names_blob) % 8)
+
+    sorted_keys = sorted(postings)
+    keys = struct.pack(f'<{len(sorted_keys)}Q', *sorted_keys)
+    terms = bytearray()
+    posting_blob = bytearray()
+    for key in sorted_keys:
+        doc_ids = postings[key]
+        terms += TERM.pack(len(posting_blob) // 4, len(doc_ids))
+        posting_blob += struct.pack(f'<{len(doc_ids)}I', *doc_ids)
+
+    # Ű 迭 8Ʈ  (mmap ״ Q 迭 )
+    names_offset = INDEX_HEADER.size + (-INDEX_HEADER.size % 8)
+    keys_offset = names_offset + len(names_blob)
+    terms_offset = keys_offset + len(keys)
+    docs_offset = terms_offset + len(terms)
+    postings_offset = docs_offset + len(docs)
+    text_offset = postings_offset + len(posting_blob)
+
+    header = INDEX_HEADER.pack(INDEX_MAGIC, INDEX_VERSION, len(names), len(messages), len(postings), names_offset,
+                               keys_offset, terms_offset, docs_offset, postings_offset, text_offset, len(text))
+
+    temp_file = index_file + '.tmp'
+    with open(temp_file, 'wb') as f:
+        f.write(header)
+        f.write(b'\0' * (names_offset - INDEX_HEADER.size))
+        f.write(names_blob)
+        f.write(keys)
+        f.write(terms)
+        f.write(docs)
+        f.write(posting_blob)
+        f.write(text)
+    os.replace(temp_file, index_file)
+
+    #   ο Ƿ 
+    if os.path.exists(delta_path(index_file)):
+        os.remove(delta_path(index_file))
+
+    print(f"{len(messages)} messages, {len(postings)} terms: {index_file}")
+
+class ScriptIndex:
+    def __init__(self, index_file):
+        self.file = open(index_file, 'rb')
+        self.data = mmap.mmap(self.file.fileno(), 0, access=mmap.ACCESS_READ)
+
+        (magic, version, archive_count, self.doc_count, self.term_count, names_offset, keys_offset,
+         self.terms_offset, self.docs_offset, self.postings_offset, self.text_offset, _) = INDEX_HEADER.unpack_from(self.data, 0)
+        if magic != INDEX_MAGIC or version != INDEX_VERSION:
+            print(f"{index_file} is not a script index.")
+            sys.exit(1)
+
+        self.names = [name.decode('utf-8') for name in self.data[names_offset:keys_offset].split(b'\0')[:archive_count]]
+        # Ű 迭  ʰ mmap   Ž,  ʿ  mmap 
+        self.view = memoryview(self.data)
+        self.keys = self.view[keys_offset:keys_offset + self.term_count * 8].cast('Q')
+        self.delta = self.read_delta(delta_path(index_file))
+
+    def close(self):
+        self.keys.release()
+        self.view.release()
+        self.data.close()
+        self.file.close()
+
+    #  : (ī̺ ̸, ׸) ->   (  켱)
+    @staticmethod
+    def read_delta(delta_file):
+        delta = {}
+        if os.path.exists(delta_file):
+            with open(delta_file, 'r', encoding='utf-8') as f:
+                for line in f:
+                    if line.strip():
+                        record = json.loads(line)
+                        delta[(record['archive'], record['entry'])] = record['messages']
+        return delta
+
+    def postings(self, key):
+        i = bisect.bisect_left(self.keys, key)
+        if i == self.term_count or self.keys[i] != key:
+            return set()
+        offset, count = TERM.unpack_from(self.data, self.terms_offset + i * TERM.size)
+        return set(struct.unpack_from(f'<{count}I', self.data, self.postings_offset + offset * 4))
+
+    def doc(self, doc_id):
+        archive, entry, message, _, offset, length = DOC.unpack_from(self.data, self.docs_offset + doc_id * DOC.size)
+        start = self.text_offset + offset
+        return self.names[archive], entry, message, self.data[start:start + length].decode('utf-8')
+
+    def all_messages(self):
+        for doc_id in range(self.doc_count):
+            name, entry, message, text = self.doc(doc_id)
+            if (name, entry) not in self.delta:
+                yield name, entry, message, text
+        for (name, entry), texts in self.delta.items():
+            for message, text in enumerate(texts):
+                yield name, entry, message, text
+
+    def search(self, terms):
+        queries = [parse_query_term(term) for term in terms]
+
+        #   ĺ    Ȯ (ؽ 浹,  n-gram )
+        candidates = None
+        for keys, _ in queries:
+            for key in keys:
+                docs = self.postings(key)
+                candidates = docs if candidates is None else candidates & docs
+                if not candidates:
+                    break
+
+        hits = []
+        for doc_id in sorted(candidates or ()):
+            name, entry, message, text = self.doc(doc_id)
+            if (name, entry) in self.delta:
+                continue
+            if self.match(queries, text):
+                hits.append((name, entry, message, text))
+
+        #  MSG  Ƿ ״ 
+        for (name, entry), texts in self.delta.items():
+            for message, text in enumerate(texts):
+                if self.match(queries, text):
+                    hits.append((name, entry, message, text))
+        return sorted(hits, key=lambda hit: hit[:3])
+
+    @staticmethod
+    def match(queries, text):
+        dialogue, tokens = split_message(text)
+        return all(check(dialogue, tokens) for _, check in queries)
+
+def decode_msg_file(msg_file):
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    moji_dict = msg2txt.load_moji_table(os.path.join(script_dir, 'Moji.tbl'))
+    pointers = msg2txt.get_pointers(msg_file, 0)
+    pointer_diff = msg2txt.calculate_difference(pointers)
+    return [text for _, text in msg2txt.decode_with_moji_and_controlcode(msg_file, 0, moji_dict, 0, pointers, pointer_diff)]
+
+# MSG ϳ ٲ  Ͽ ߰ (  ״)
+def update_index(index_file, archive_name, msg_file):
+    prefix = os.path.basename(msg_file)[:4]
+    if not prefix.isdigit():
+        print(f"{msg_file} does not start with a 4-digit entry number.")
+        sys.exit(1)
+
+    index = ScriptIndex(index_file)
+    known = archive_name in index.names
+    index.close()
+    if not known:
+        print(f"Warning: {archive_name} is not in the index, adding it as a new archive.")
+
+    record = {'archive': archive_name, 'entry': int(prefix), 'messages': decode_msg_file(msg_file)}
+    with open(delta_path(index_file), 'a', encoding='utf-8') as f:
+        f.write(json.dumps(record, ensure_ascii=False) + '\n')
+    print(f"Updated {archive_name} entry {record['entry']:04d} ({len(record['messages'])} messages)")
+
+#   ο ħ
+def merge_index(index_file):
+    index = ScriptIndex(index_file)
+    names = list(index.names)
+    archive_numbers = {name: i for i, name in enumerate(names)}
+    messages = []
+    for name, entry, message, text in index.all_messages():
+        if name not in archive_numbers:
+            archive_numbers[name] = len(names)
+            names.append(name)
+        messages.append((archive_numbers[name], entry, message, text))
+    index.close()
+    write_index(index_file, names, messages)
+
+def print_hits(hits, elapsed):
+    for name, entry, message, text in hits:
+        first_line = SEPARATORS.split(text.strip('\n\t'))[0]
+        print(f"{name}\t{entry:04d}\t{message:04d}\t{first_line}")
+    print(f"{len(hits)} hits ({elapsed * 1000:.1f} ms)", file=sys.stderr)
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        print("Usage: python scriptidx.py -b <script_db> <index_file>          # build mode")
+        print("       python scriptidx.py -s <index_file> <query> [<query>...]  # search mode")
+        print("       python scriptidx.py -u <index_file> <archive> <msg_file>  # update mode")
+        print("       python scriptidx.py -m <index_file>                       # merge mode")
+        sys.exit(1)
+
+    mode = sys.argv[1]
+    if mode == '-b' and len(sys.argv) == 4:
+        names, messages = read_script_db(sys.argv[2])
+        write_index(sys.argv[3], names, messages)
+    elif mode == '-s' and len(sys.argv) >= 4:
+        index = ScriptIndex(sys.argv[2])
+        start = time.perf_counter()
+        hits = index.search(sys.argv[3:])
+        print_hits(hits, time.perf_counter() - start)
+        index.close()
+    elif mode == '-u' and len(sys.argv) == 5:
+        update_index(sys.argv[2], sys.argv[3], sys.argv[4])
+    elif mode == '-m' and len(sys.argv) == 3:
+        merge_index(sys.argv[2])
+    else:
+        print("Invalid mode. Use -b to build, -s to search, -u to update or -m to merge.")
+        sys.exit(1)
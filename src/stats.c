@@ -0,0 +1,214 @@
+/*******************************************************************************
+ *
+ *  Filename:  stats.c
+ *
+ *  Description:  Phase timers and codec counters shared by the tools.
+ *  Included directly by each tool (like endian.c) and enabled with
+ *  --stats (text) or --stats=json, printed to stderr on exit.
+ *
+ *  Author:  happy_land
+ *  Date:  2026-10-18
+ *  Last update:  --
+ *
+ *******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <time.h>
+#include <sys/resource.h>
+#endif
+
+#define STATS_MAX_LENGTH    32
+
+enum { STATS_OFF, STATS_TEXT, STATS_JSON };
+enum { PHASE_READ, PHASE_PROCESS, PHASE_WRITE, PHASE_COUNT };
+
+typedef struct {
+    int mode;
+    int has_codec;                  // ڵ ī   (MELTTIMTool)
+    const char *tool;
+    const char *command;
+    const char *input;
+    const char *phase_names[PHASE_COUNT];
+    double start;
+    double phase_start[PHASE_COUNT];
+    double phase_time[PHASE_COUNT];
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint64_t literals;
+    uint64_t matches;
+    uint64_t window_advances;
+    uint64_t probes;                // find_match()  ĺ ġ 
+    uint64_t match_lengths[STATS_MAX_LENGTH + 1];  // Ʈ  ̺ ġ 
+} Stats;
+
+Stats stats;
+
+//   ð ( , CPU ð ƴ   ð)
+double stats_now(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+// ִ ޸ 뷮 (Ʈ)
+uint64_t stats_peak_rss(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return (uint64_t)usage.ru_maxrss;
+#else
+    return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+// --stats ɼ ã  Ͽ 
+void stats_parse_args(int *argc, char *argv[], const char *tool) {
+    int count = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=text") == 0) {
+            stats.mode = STATS_TEXT;
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            stats.mode = STATS_JSON;
+        } else if (strncmp(argv[i], "--stats=", 8) == 0) {
+            fprintf(stderr, "Invalid stats format: %s (use --stats or --stats=json)\n", argv[i] + 8);
+            exit(1);
+        } else {
+            argv[count++] = argv[i];
+        }
+    }
+    *argc = count;
+    argv[count] = NULL;
+
+    stats.tool = tool;
+    stats.command = count > 1 ? argv[1] : "";
+    stats.input = count > 2 ? argv[2] : "";
+    stats.phase_names[PHASE_READ] = "read";
+    stats.phase_names[PHASE_PROCESS] = "process";
+    stats.phase_names[PHASE_WRITE] = "write";
+    stats.start = stats_now();
+}
+
+void stats_begin(int phase) {
+    stats.phase_start[phase] = stats_now();
+}
+
+void stats_end(int phase) {
+    stats.phase_time[phase] += stats_now() - stats.phase_start[phase];
+}
+
+void stats_match(size_t length) {
+    stats.matches++;
+    stats.match_lengths[length < STATS_MAX_LENGTH ? length : STATS_MAX_LENGTH]++;
+}
+
+uint64_t stats_file_size(const char *filename) {
+    struct stat st;
+    return stat(filename, &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+// JSON ڿ  ( ÿ ǥ ó)
+void stats_print_string(const char *value) {
+    fputc('"', stderr);
+    for (; *value; value++) {
+        if (*value == '"' || *value == '\\') {
+            fputc('\\', stderr);
+        }
+        fputc(*value, stderr);
+    }
+    fputc('"', stderr);
+}
+
+void stats_report(void) {
+    if (stats.mode == STATS_OFF) {
+        return;
+    }
+
+    double wall_time = stats_now() - stats.start;
+    uint64_t peak_rss = stats_peak_rss();
+
+    if (stats.mode == STATS_TEXT) {
+        fprintf(stderr, "%s %s %s\n", stats.tool, stats.command, stats.input);
+        fprintf(stderr, "  wall time:       %.6f s\n", wall_time);
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            fprintf(stderr, "  %-16s %.6f s\n", stats.phase_names[i], stats.phase_time[i]);
+        }
+        fprintf(stderr, "  bytes read:      %llu\n", (unsigned long long)stats.bytes_read);
+        fprintf(stderr, "  bytes written:   %llu\n", (unsigned long long)stats.bytes_written);
+        if (stats.has_codec) {
+            fprintf(stderr, "  literals:        %llu\n", (unsigned long long)stats.literals);
+            fprintf(stderr, "  matches:         %llu\n", (unsigned long long)stats.matches);
+            fprintf(stderr, "  window advances: %llu\n", (unsigned long long)stats.window_advances);
+            fprintf(stderr, "  probes:          %llu\n", (unsigned long long)stats.probes);
+            for (int i = 0; i <= STATS_MAX_LENGTH; i++) {
+                if (stats.match_lengths[i]) {
+                    fprintf(stderr, "  match length %2d%s %llu\n", i, i == STATS_MAX_LENGTH ? "+:" : ":",
+                            (unsigned long long)stats.match_lengths[i]);
+                }
+            }
+        }
+        fprintf(stderr, "  peak RSS:        %llu\n", (unsigned long long)peak_rss);
+        return;
+    }
+
+    //  ٿ ü ϳ (    ̾ ٿ ó  ֵ)
+    fprintf(stderr, "{\"tool\":");
+    stats_print_string(stats.tool);
+    fprintf(stderr, ",\"command\":");
+    stats_print_string(stats.command);
+    fprintf(stderr, ",\"input\":");
+    stats_print_string(stats.input);
+    fprintf(stderr, ",\"wall_time\":%.6f,\"phases\":{", wall_time);
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        fprintf(stderr, "%s\"%s\":%.6f", i ? "," : "", stats.phase_names[i], stats.phase_time[i]);
+    }
+    fprintf(stderr, "},\"bytes_read\":%llu,\"bytes_written\":%llu",
+            (unsigned long long)stats.bytes_read, (unsigned long long)stats.bytes_written);
+    if (stats.has_codec) {
+        fprintf(stderr, ",\"codec\":{\"literals\":%llu,\"matches\":%llu,\"window_advances\":%llu,\"probes\":%llu,\"match_lengths\":{",
+                (unsigned long long)stats.literals, (unsigned long long)stats.matches,
+                (unsigned long long)stats.window_advances, (unsigned long long)stats.probes);
+        int first = 1;
+        for (int i = 0; i <= STATS_MAX_LENGTH; i++) {
+            if (stats.match_lengths[i]) {
+                fprintf(stderr, "%s\"%d\":%llu", first ? "" : ",", i, (unsigned long long)stats.match_lengths[i]);
+                first = 0;
+            }
+        }
+        fprintf(stderr, "}}");
+    }
+    fprintf(stderr, ",\"peak_rss\":%llu}\n", (unsigned long long)peak_rss);
+}
+
+/*==============================================================*/
+/*	"stats.c"	End of File										*/
+/*==============================================================*/
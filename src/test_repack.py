@@ -0,0 +1,129 @@
+# -*- coding: cp949 -*-
+"""
+test_repack.py
+
+Description: Test of repack.py on a project folder extracted with combbin.py -X.
+Author: happy_land
+Date: 26-10-18
+Last update: --
+
+Functionality:
+- Build two identical archives and extract them with -X, so every entry of the second archive
+  is a hardlink to the same object under .objects as the entry of the first one.
+- Rebuild the first archive from edited sources (PIX copy, TXT -> MSG, PIX -> MTIM) and check
+  that the second archive's files, its BIN and the store keep their content.
+- MSGTool and MELTTIMTool are used when they are built next to this file, as in repack.py.
+
+Usage: python test_repack.py
+"""
+
+import io
+import os
+import glob
+import shutil
+import struct
+import tempfile
+import unittest
+import contextlib
+
+import combbin
+import repack
+import txt2msg
+
+HEADER_SIZE = 0x30
+KIND_PIX = 0x02
+KIND_MTIM = 0x03
+KIND_MSG = 0x12
+
+def entry_header(kind, width=0, height=0):
+    header = bytearray(HEADER_SIZE)
+    struct.pack_into('<I', header, 0x00, kind)
+    struct.pack_into('<HH', header, 0x18, width, height)
+    return bytes(header)
+
+def write_bytes(path, data):
+    with open(path, 'wb') as f:
+        f.write(data)
+
+def read_bytes(path):
+    with open(path, 'rb') as f:
+        return f.read()
+
+def folder_contents(folder):
+    return {os.path.relpath(path, folder): read_bytes(path)
+            for path in glob.glob(os.path.join(folder, '**', '*'), recursive=True) if os.path.isfile(path)}
+
+class RepackLinkedTreeTest(unittest.TestCase):
+    def setUp(self):
+        self.root = tempfile.mkdtemp()
+        self.archive_folder = os.path.join(self.root, 'archives')
+        self.project_folder = os.path.join(self.root, 'project')
+        self.source_folder = os.path.join(self.root, 'source', 'ST90')
+        self.has_mtim = repack.dash2.available() or os.path.exists(repack.tool_path('MELTTIMTool'))
+
+        #    ī̺긦 ̸ ٲ ϳ  
+        original = os.path.join(self.root, 'original', 'ST90')
+        os.makedirs(original)
+        os.makedirs(self.archive_folder)
+        os.makedirs(self.source_folder)
+
+        txt_file = os.path.join(original, '0001_ST90.TXT')
+        with open(txt_file, 'w', encoding='utf-8') as f:
+            f.write('_0102_0304end\n--\n_0506end\n')
+        # PIX ׸   е Ƿ 0x800 迡  ´ ũ (0x30 + 0x7d0 + 0x800) 
+        headers = [entry_header(KIND_PIX, 16, 64), entry_header(KIND_MSG)]
+        write_bytes(os.path.join(original, '0000_ST90.PIX'), bytes(range(256)) * 8)
+        write_bytes(os.path.join(original, '0001_ST90.MSG'), txt2msg.txt_to_bin(txt_file))
+        os.remove(txt_file)
+        if self.has_mtim:
+            headers.append(entry_header(KIND_MTIM, 8, 4))
+            write_bytes(os.path.join(original, '0002_ST90.MTIM'), bytes(0x40))
+        write_bytes(os.path.join(original, 'HEADER.BIN'), b''.join(headers))
+
+        with contextlib.redirect_stdout(io.StringIO()):
+            combbin.combine_files(original, self.archive_folder)
+            shutil.copyfile(os.path.join(self.archive_folder, 'ST90.BIN'), os.path.join(self.archive_folder, 'ST91.BIN'))
+            combbin.extract_all(self.archive_folder, self.project_folder, 1)
+
+        # ST90 ģ ҽ ٽ 
+        write_bytes(os.path.join(self.source_folder, '0000_ST90.PIX'), bytes(range(255, -1, -1)) * 8)
+        with open(os.path.join(self.source_folder, '0001_ST90.TXT'), 'w', encoding='utf-8') as f:
+            f.write('_0102_0304end\n--\n_0708_090aend\n')
+        if self.has_mtim:
+            write_bytes(os.path.join(self.source_folder, '0002_ST90.PIX'), bytes(range(0x40)) * 2)
+
+    def tearDown(self):
+        shutil.rmtree(self.root)
+
+    def test_linked_entries_are_not_written_through(self):
+        linked = os.path.join(self.project_folder, 'ST91', '0000_ST91.PIX')
+        self.assertGreater(os.stat(linked).st_nlink, 1, "the file system does not support hardlinks")
+
+        store_folder = os.path.join(self.project_folder, '.objects')
+        other_folder = os.path.join(self.project_folder, 'ST91')
+        store_before = folder_contents(store_folder)
+        other_before = folder_contents(other_folder)
+        other_archive = read_bytes(os.path.join(self.archive_folder, 'ST91.BIN'))
+        edited_before = folder_contents(os.path.join(self.project_folder, 'ST90'))
+
+        with contextlib.redirect_stdout(io.StringIO()):
+            result = repack.Repack(self.project_folder, os.path.dirname(self.source_folder), self.archive_folder, 2).run()
+        self.assertEqual(result, 0)
+
+        # ģ ׸   ǰ
+        edited_after = folder_contents(os.path.join(self.project_folder, 'ST90'))
+        self.assertEqual(edited_after['0000_ST90.PIX'], bytes(range(255, -1, -1)) * 8)
+        self.assertNotEqual(edited_after['0001_ST90.MSG'], edited_before['0001_ST90.MSG'])
+        if self.has_mtim:
+            self.assertNotEqual(edited_after['0002_ST90.MTIM'], edited_before['0002_ST90.MTIM'])
+        self.assertFalse(glob.glob(os.path.join(self.project_folder, 'ST90', '*.tmp')))
+        self.assertIn(bytes(range(255, -1, -1)) * 8, read_bytes(os.path.join(self.archive_folder, 'ST90.BIN')))
+
+        # ũ ϴ ٸ ī̺ Ҵ ״
+        self.assertEqual(folder_contents(store_folder), store_before)
+        self.assertEqual(folder_contents(other_folder), other_before)
+        self.assertEqual(read_bytes(os.path.join(self.archive_folder, 'ST91.BIN')), other_archive)
+        self.assertGreater(os.stat(linked).st_nlink, 1)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,355 @@
+# -*- coding: cp949 -*-
+"""
+texfind.py
+
+Description: Script to find the archive entry behind a texture seen in a VRAM dump.
+Author: happy_land
+Date: 26-10-18
+Last update: --
+
+Functionality:
+- Build an index of every decoded image payload (TIM, PIX, CLT and MTIM, with their CLUTs)
+  of a folder of BIN archives or of a CD image, hashing short blocks of each pixel row.
+- Look up a rectangle of a VRAM snapshot (PCSX 1.5 savestate, the 16bpp TIM of VRAMTool
+  or a raw 1MB dump) by rolling the same hash over its rows, then verify every candidate
+  position against the indexed pixels.
+- Print the archive, entry and offset of each match.
+"""
+
+import os
+import sys
+import glob
+import gzip
+import mmap
+import time
+import struct
+import bisect
+
+import combbin
+import cdimage
+
+HEADER_SIZE = combbin.HEADER_SIZE
+PADDED_CLUT_SIZE = combbin.PADDED_CLUT_SIZE
+
+KIND_TIM = 0x02     # TIM, PIX, CLT
+KIND_MTIM = 0x03
+
+VRAM_WIDTH = 1024
+VRAM_HEIGHT = 512
+VRAM_SIZE = VRAM_WIDTH * VRAM_HEIGHT * 2
+PCSX_VRAM_OFFSET = 0x2996C0     # tim2bmp_read_pcsx15 (  ̺ Ʈ  VRAM)
+
+INDEX_MAGIC = b'D2TX'
+INDEX_VERSION = 1
+INDEX_HEADER = struct.Struct('<4s9I')
+TEXTURE = struct.Struct('<2H2B4HII')   # ī̺, ׸, , κ, ʺ, , VRAM x, y, ׸  ġ, ȼ ġ
+POSTING = struct.Struct('<I2H')         # ؽó, , 
+
+PART_IMAGE = 0
+PART_CLUT = 1
+PART_NAMES = ('image', 'clut')
+
+# 16Ʈ  BLOCK_UNITS   ؽ (ึ BLOCK_UNITS  )
+#  ϳ  ˻ 簢 ʺ 2 * BLOCK_UNITS - 1 ̻̾ 
+BLOCK_UNITS = 4
+BLOCK_SIZE = BLOCK_UNITS * 2
+PRIME = (1 << 61) - 1
+RADIX = 1 << 16
+LEAD_POWER = pow(RADIX, BLOCK_UNITS - 1, PRIME)
+
+MAX_POSTINGS = 256      # ̺   ġ  ϹǷ ǳʶ
+MAX_PROBE_ROWS = 16     # ˻ 簢 ؽø   
+MAX_VERIFY = 64         # Ȯ ĺ 
+MIN_VOTE_RATIO = 16
+
+def block_key(block):
+    """ (Ʈ) 2Ʈ ū ڸ  RADIX   mod PRIME (Rabin-Karp)"""
+    return int.from_bytes(block, 'big') % PRIME
+
+def rolling_keys(row):
+    """  ġ  ؽø  (, Ű) ȯ"""
+    if len(row) < BLOCK_SIZE:
+        return
+    key = block_key(row[:BLOCK_SIZE])
+    yield 0, key
+    for column in range(1, len(row) // 2 - BLOCK_UNITS + 1):
+        old = (row[column * 2 - 2] << 8) | row[column * 2 - 1]
+        end = (column + BLOCK_UNITS) * 2
+        new = (row[end - 2] << 8) | row[end - 1]
+        key = ((key - old * LEAD_POWER) * RADIX + new) % PRIME
+        yield column, key
+
+def is_flat(block):
+    # ܻ  𿡳 Ƿ  
+    return block == block[:2] * BLOCK_UNITS
+
+# ׸ ϳ ̹ CLUT (κ, ʺ, , VRAM x, y, ׸  ġ, ) 
+def entry_textures(header, data):
+    kind = struct.unpack_from('<I', header, 0)[0]
+    clut_x, clut_y, clut_w, clut_h, image_x, image_y, image_w, image_h = struct.unpack_from('<8H', header, 0x0c)
+
+    if kind == KIND_MTIM:
+        import dash2  # MTIM   libdash2.so ʿ
+        data = dash2.decompress(header, data)
+        # ȷƮ Բ   (CLUT 0x7d0 + ȼ)
+        has_clut = clut_w and len(data) >= PADDED_CLUT_SIZE + image_w * image_h * 2
+        image_offset = PADDED_CLUT_SIZE if has_clut else 0
+    elif kind == KIND_TIM:
+        has_clut = clut_w   # CLT CLUT, TIM PIX CLUT  (0x7d0) ڰ ȼ
+        image_offset = PADDED_CLUT_SIZE
+    else:
+        return []
+
+    textures = []
+    if has_clut and clut_h:
+        textures.append((PART_CLUT, clut_w, clut_h, clut_x, clut_y, 0, data[:clut_w * clut_h * 2]))
+    if image_w and image_h:
+        pixels = data[image_offset:image_offset + image_w * image_h * 2]
+        textures.append((PART_IMAGE, image_w, len(pixels) // (image_w * 2), image_x, image_y, image_offset, pixels))
+    return [texture for texture in textures if texture[2] > 0 and len(texture[6]) >= texture[1] * texture[2] * 2]
+
+def list_archives(source):
+    """(ī̺ ̸,  Լ) :    BIN ī̺, ̸ CD ̹"""
+    if os.path.isdir(source):
+        paths = sorted(path for path in glob.glob(os.path.join(source, '**', '*.BIN'), recursive=True)
+                       if os.path.basename(path).upper() != 'HEADER.BIN')
+        return [(os.path.splitext(os.path.relpath(path, source))[0].replace('\\', '/'), lambda path=path: open(path, 'rb'))
+                for path in paths]
+    image = cdimage.CdImage(source)
+    paths = sorted(path for path in image.files if path.endswith('.BIN'))
+    return [(os.path.splitext(path)[0], lambda path=path: image.open(path)) for path in paths]
+
+def build_index(source, index_file):
+    names = []
+    textures = bytearray()
+    pixels = bytearray()
+    blocks = []
+    skipped = 0
+
+    for name, open_archive in list_archives(source):
+        archive = len(names)
+        names.append(name)
+        with open_archive() as f:
+            for entry, (offset, header, padded_size) in enumerate(combbin.read_archive_layout(f)):
+                f.seek(offset + HEADER_SIZE)
+                data = f.read(padded_size - HEADER_SIZE)
+                try:
+                    parts = entry_textures(header, data)
+                except (OSError, ValueError) as e:
+                    print(f"Skipped {name} {entry:04d}: {e}")
+                    skipped += 1
+                    continue
+
+                kind = struct.unpack_from('<I', header, 0)[0]
+                for part, width, height, x, y, data_offset, texture_data in parts:
+                    texture_id = len(textures) // TEXTURE.size
+                    textures += TEXTURE.pack(archive, entry, kind, part, width, height, x, y, data_offset, len(pixels))
+                    pixels += texture_data
+
+                    row_size = width * 2
+                    for row in range(height):
+                        line = texture_data[row * row_size:(row + 1) * row_size]
+                        for column in range(0, width - BLOCK_UNITS + 1, BLOCK_UNITS):
+                            block = line[column * 2:column * 2 + BLOCK_SIZE]
+                            if not is_flat(block):
+                                blocks.append((block_key(block), texture_id, row, column))
+
+    blocks.sort()
+    keys = struct.pack(f'<{len(blocks)}Q', *(block[0] for block in blocks))
+    postings = b''.join(POSTING.pack(texture_id, row, column) for _, texture_id, row, column in blocks)
+
+    names_blob = b''.join(name.encode('utf-8') + b'\0' for name in names)
+    names_blob += b'\0' * (-len(names_blob) % 8)
+
+    # Ű 迭 8Ʈ  (mmap ״ Q 迭 )
+    names_offset = INDEX_HEADER.size + (-INDEX_HEADER.size % 8)
+    keys_offset = names_offset + len(names_blob)
+    postings_offset = keys_offset + len(keys)
+    textures_offset = postings_offset + len(postings)
+    pixels_offset = textures_offset + len(textures)
+    header = INDEX_HEADER.pack(INDEX_MAGIC, INDEX_VERSION, len(names), len(textures) // TEXTURE.size, len(blocks),
+                               names_offset, keys_offset, postings_offset, textures_offset, pixels_offset)
+
+    temp_file = index_file + '.tmp'
+    with open(temp_file, 'wb') as f:
+        f.write(header)
+        f.write(b'\0' * (names_offset - INDEX_HEADER.size))
+        f.write(names_blob)
+        f.write(keys)
+        f.write(postings)
+        f.write(textures)
+        f.write(pixels)
+    os.replace(temp_file, index_file)
+
+    print(f"{len(names)} archives, {len(textures) // TEXTURE.size} textures, {len(blocks)} blocks"
+          f"{f', {skipped} entries skipped' if skipped else ''}: {index_file}")
+
+def read_vram(vram_file):
+    """VRAM 1024x512 (16Ʈ ) Ʈ """
+    with open(vram_file, 'rb') as f:
+        head = f.read(2)
+    if head == b'\x1f\x8b':  # PCSX 1.5 ̺ Ʈ (gzip)
+        with gzip.open(vram_file, 'rb') as f:
+            f.seek(PCSX_VRAM_OFFSET)
+            data = f.read(VRAM_SIZE)
+    else:
+        with open(vram_file, 'rb') as f:
+            data = f.read()
+        # 16bpp TIM (VRAMTool ): ̹  ڰ VRAM
+        if len(data) >= 0x14 and struct.unpack_from('<2I', data, 0) == (0x10, 0x02):
+            _, x, y, width, height = struct.unpack_from('<I4H', data, 0x08)
+            if (x, y, width, height) != (0, 0, VRAM_WIDTH, VRAM_HEIGHT):
+                print(f"Error: {vram_file} is not a full 1024x512 VRAM image")
+                sys.exit(1)
+            data = data[0x14:0x14 + VRAM_SIZE]
+    if len(data) < VRAM_SIZE:
+        print(f"Error: {vram_file} is too short for a 1024x512 VRAM")
+        sys.exit(1)
+    return data[:VRAM_SIZE]
+
+class TextureIndex:
+    def __init__(self, index_file):
+        self.file = open(index_file, 'rb')
+        self.data = mmap.mmap(self.file.fileno(), 0, access=mmap.ACCESS_READ)
+
+        (magic, version, archive_count, self.texture_count, self.block_count, names_offset,
+         keys_offset, self.postings_offset, self.textures_offset, self.pixels_offset) = INDEX_HEADER.unpack_from(self.data, 0)
+        if magic != INDEX_MAGIC or version != INDEX_VERSION:
+            print(f"{index_file} is not a texture index.")
+            sys.exit(1)
+
+        self.names = [name.decode('utf-8') for name in self.data[names_offset:keys_offset].split(b'\0')[:archive_count]]
+        # Ű 迭  ʰ mmap   Ž
+        self.view = memoryview(self.data)
+        self.keys = self.view[keys_offset:keys_offset + self.block_count * 8].cast('Q')
+
+    def close(self):
+        self.keys.release()
+        self.view.release()
+        self.data.close()
+        self.file.close()
+
+    def texture(self, texture_id):
+        return TEXTURE.unpack_from(self.data, self.textures_offset + texture_id * TEXTURE.size)
+
+    def postings(self, key):
+        start = bisect.bisect_left(self.keys, key)
+        end = start
+        while end < self.block_count and self.keys[end] == key and end - start <= MAX_POSTINGS:
+            end += 1
+        if end - start > MAX_POSTINGS:
+            return ()
+        return [POSTING.unpack_from(self.data, self.postings_offset + i * POSTING.size) for i in range(start, end)]
+
+    def verify(self, vram, texture_id, origin_x, origin_y, rect):
+        """ؽó VRAM (origin_x, origin_y)   ˻ 簢 ġ κп  ȼ 
+
+        ߿ ö ؽó Ϻθ   Ƿ   ϰ,
+        ġ κ  ̻     
+        """
+        x, y, width, height = rect
+        _, _, _, _, texture_w, texture_h, _, _, _, pixel_offset = self.texture(texture_id)
+        if origin_x < 0 or origin_y < 0:
+            return 0  # ؽó   VRAM ȿ ־ 
+        left = max(x, origin_x)
+        right = min(x + width, origin_x + texture_w)
+        top = max(y, origin_y)
+        bottom = min(y + height, origin_y + texture_h)
+        if left >= right or top >= bottom:
+            return 0
+
+        start = self.pixels_offset + pixel_offset
+        row_size = (right - left) * 2
+
+        def matched_units(rows):
+            matched = 0
+            for row in rows:
+                source = start + ((row - origin_y) * texture_w + left - origin_x) * 2
+                target = (row * VRAM_WIDTH + left) * 2
+                texture_row = self.data[source:source + row_size]
+                vram_row = vram[target:target + row_size]
+                if texture_row == vram_row:
+                    matched += right - left
+                    continue
+                for i in range(0, row_size, BLOCK_SIZE):
+                    if texture_row[i:i + BLOCK_SIZE] == vram_row[i:i + BLOCK_SIZE]:
+                        matched += min(BLOCK_SIZE, row_size - i) // 2
+            return matched
+
+        #  ุ  ؼ Ʋ ĺ  
+        sample = range(top, bottom, max(1, (bottom - top) // MAX_PROBE_ROWS))
+        if matched_units(sample) * 2 < (right - left) * len(sample):
+            return 0
+        matched = matched_units(range(top, bottom))
+        return matched if matched * 2 >= (right - left) * (bottom - top) else 0
+
+    def find(self, vram, rect):
+        x, y, width, height = rect
+        # ˻ 簢 ȿ    ؽø 
+        step = max(1, height // MAX_PROBE_ROWS)
+        votes = {}
+        for row in range(y, y + height, step):
+            line = vram[(row * VRAM_WIDTH + x) * 2:(row * VRAM_WIDTH + x + width) * 2]
+            for column, key in rolling_keys(line):
+                if is_flat(line[column * 2:column * 2 + BLOCK_SIZE]):
+                    continue
+                for texture_id, texture_row, texture_column in self.postings(key):
+                    #   ؽó   VRAM  ־ ϴ 
+                    candidate = (texture_id, x + column - texture_column, row - texture_row)
+                    votes[candidate] = votes.get(candidate, 0) + 1
+
+        # ǥ   ĺ 1/MIN_VOTE_RATIO  Ǵ ĺ 쿬  
+        ranked = sorted(votes.items(), key=lambda item: -item[1])[:MAX_VERIFY]
+        min_votes = ranked[0][1] // MIN_VOTE_RATIO if ranked else 0
+        hits = []
+        for candidate, count in ranked:
+            if count < min_votes:
+                break
+            texture_id, origin_x, origin_y = candidate
+            area = self.verify(vram, texture_id, origin_x, origin_y, rect)
+            if area:
+                hits.append((area, texture_id, origin_x, origin_y))
+        hits.sort(key=lambda hit: (-hit[0], hit[1]))
+        return hits
+
+    def print_hits(self, hits, rect, elapsed):
+        x, y, width, height = rect
+        for area, texture_id, origin_x, origin_y in hits:
+            archive, entry, kind, part, texture_w, texture_h, vram_x, vram_y, data_offset, _ = self.texture(texture_id)
+            extension = 'MTIM' if kind == KIND_MTIM else 'TIM'
+            # ˻ 簢   ؽó ȿ ִ ġ
+            inner_x = max(x, origin_x) - origin_x
+            inner_y = max(y, origin_y) - origin_y
+            offset = data_offset + (inner_y * texture_w + inner_x) * 2
+            note = '' if (vram_x, vram_y) == (origin_x, origin_y) else f" (header says {vram_x},{vram_y})"
+            print(f"{self.names[archive]}\t{entry:04d}\t{extension}\t{PART_NAMES[part]}\t"
+                  f"{inner_x},{inner_y} in {texture_w}x{texture_h}\toffset 0x{offset:x}\t"
+                  f"at {origin_x},{origin_y}{note}\t{area * 100 // (width * height)}%")
+        print(f"{len(hits)} hits ({elapsed * 1000:.1f} ms)", file=sys.stderr)
+
+if __name__ == '__main__':
+    if len(sys.argv) < 4:
+        print("Usage: python texfind.py -b <archive_folder|image.cue> <index_file>                 # build mode")
+        print("       python texfind.py -f <index_file> <vram_file> <x> <y> <width> <height>       # find mode")
+        print("         (<vram_file>: PCSX 1.5 savestate, 16bpp VRAM TIM from VRAMTool or raw 1MB dump;")
+        print(f"          x and width in 16-bit VRAM units, width >= {2 * BLOCK_UNITS - 1})")
+        sys.exit(1)
+
+    mode = sys.argv[1]
+    if mode == '-b' and len(sys.argv) == 4:
+        build_index(sys.argv[2], sys.argv[3])
+    elif mode == '-f' and len(sys.argv) == 8:
+        rect = tuple(int(value, 0) for value in sys.argv[4:8])
+        x, y, width, height = rect
+        if x < 0 or y < 0 or width < 2 * BLOCK_UNITS - 1 or height < 1 or x + width > VRAM_WIDTH or y + height > VRAM_HEIGHT:
+            print(f"Error: The rectangle must lie inside the VRAM and be at least {2 * BLOCK_UNITS - 1} units wide")
+            sys.exit(1)
+        vram = read_vram(sys.argv[3])
+        index = TextureIndex(sys.argv[2])
+        start = time.perf_counter()
+        hits = index.find(vram, rect)
+        index.print_hits(hits, rect, time.perf_counter() - start)
+        index.close()
+    else:
+        print("Invalid mode. Use -b to build or -f to find.")
+        sys.exit(1)
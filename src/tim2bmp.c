@@ -10,6 +10,23 @@
 #include <stdlib.h>
 #include <string.h>
 #include <zlib.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#define make_dir(path) _mkdir(path)
+#define truncate_file(f, size) _chsize(_fileno(f), size)
+#else
+#include <unistd.h>
+#define make_dir(path) mkdir(path, 0755)
+#define truncate_file(f, size) ftruncate(fileno(f), size)
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define TIM2BMP_SSSE3
+#endif
 
 #define PCSX_1_5_SAVESTATE_SUPPORT
 
@@ -27,11 +44,13 @@ typedef struct
 	unsigned char compr; // Compression - 0 = normal, 1 = GZIP
 	unsigned char has_clut;
 	unsigned short *clut;
+	unsigned int clut_len; // Number of CLUT entries, all palettes together
 }tim2bmp_info;
 
 tim2bmp_info	tim_info;
 
 #include "endian.c"
+#include "stats.c"
 
 int mpink_flag = 0;
 
@@ -65,7 +84,9 @@ int write_bitmap_headers(FILE *f, int w, int h, int bpp)
 	
 	// Calculate and write size of bitmap
 	
-	if(bpp == 24)
+	if(bpp == 32)
+		r = w * 4;
+	else if(bpp == 24)
 		r = w * 3;
 	else if(bpp == 8)
 		r = w;
@@ -160,6 +181,8 @@ int tim2bmp_read_tim(char *ip, tim2bmp_info *t)
 		
 		for(x = 0; x < (tim_cw * tim_ch); x++)
 			t->clut[x] = read_le_word(i);		
+
+		t->clut_len = tim_cw * tim_ch;
 	}
 	
 	bl = read_le_dword(i);
@@ -324,6 +347,718 @@ void tim2bmp_convert_image_data(char *ip, char *fp, tim2bmp_info *t)
 	if(t->compr == 1) gzclose(gzf);
 }
 
+// Palette entry as a 32-bit BGRA bitmap pixel. Entry 0x0000 is the
+// transparent color on the PSX, so it gets alpha 0 (unless -mpink).
+unsigned int rgbpsx_to_bgra32(unsigned short psx_c)
+{
+	unsigned char r, g, b, a;
+
+	rgbpsx_to_rgb24(psx_c, &r, &g, &b);
+	a = (psx_c == 0 && !mpink_flag) ? 0 : 255;
+
+	return b | (g << 8) | (r << 16) | ((unsigned int)a << 24);
+}
+
+void tim2bmp_expand_row(const unsigned char *idx, const unsigned int *pal,
+	unsigned int *out, int w)
+{
+	int x;
+
+	for(x = 0; x < w; x++)
+		out[x] = pal[idx[x]];
+}
+
+#ifdef TIM2BMP_SSSE3
+// 16-color palettes fit in one register per channel, so pshufb looks up
+// 16 pixels at once and the four channels are interleaved back to BGRA.
+__attribute__((target("ssse3")))
+void tim2bmp_expand_row16_ssse3(const unsigned char *idx,
+	const unsigned int *pal, unsigned int *out, int w)
+{
+	unsigned char planes[4][16];
+	__m128i pb, pg, pr, pa;
+	__m128i i, b, g, r, a, bg_lo, bg_hi, ra_lo, ra_hi;
+	int x, c;
+
+	for(c = 0; c < 16; c++)
+	{
+		planes[0][c] = pal[c] & 0xff;
+		planes[1][c] = (pal[c] >> 8) & 0xff;
+		planes[2][c] = (pal[c] >> 16) & 0xff;
+		planes[3][c] = pal[c] >> 24;
+	}
+
+	pb = _mm_loadu_si128((const __m128i*)planes[0]);
+	pg = _mm_loadu_si128((const __m128i*)planes[1]);
+	pr = _mm_loadu_si128((const __m128i*)planes[2]);
+	pa = _mm_loadu_si128((const __m128i*)planes[3]);
+
+	for(x = 0; x + 16 <= w; x += 16)
+	{
+		i = _mm_loadu_si128((const __m128i*)(idx + x));
+		b = _mm_shuffle_epi8(pb, i);
+		g = _mm_shuffle_epi8(pg, i);
+		r = _mm_shuffle_epi8(pr, i);
+		a = _mm_shuffle_epi8(pa, i);
+
+		bg_lo = _mm_unpacklo_epi8(b, g);
+		bg_hi = _mm_unpackhi_epi8(b, g);
+		ra_lo = _mm_unpacklo_epi8(r, a);
+		ra_hi = _mm_unpackhi_epi8(r, a);
+
+		_mm_storeu_si128((__m128i*)(out + x), _mm_unpacklo_epi16(bg_lo, ra_lo));
+		_mm_storeu_si128((__m128i*)(out + x + 4), _mm_unpackhi_epi16(bg_lo, ra_lo));
+		_mm_storeu_si128((__m128i*)(out + x + 8), _mm_unpacklo_epi16(bg_hi, ra_hi));
+		_mm_storeu_si128((__m128i*)(out + x + 12), _mm_unpackhi_epi16(bg_hi, ra_hi));
+	}
+
+	tim2bmp_expand_row(idx + x, pal, out + x, w - x);
+}
+#endif
+
+// Name of the bitmap for one palette: out.bmp -> out_00.bmp, out_01.bmp...
+void tim2bmp_palette_file_name(char *dst, size_t size, char *fp, int p)
+{
+	char *ext = strrchr(fp, '.');
+	char *sep = strrchr(fp, '/');
+	char *sep2 = strrchr(fp, '\\');
+	int base_len;
+
+	if(sep2 > sep)
+		sep = sep2;
+
+	if(ext == NULL || (sep != NULL && ext < sep))
+		ext = fp + strlen(fp);
+
+	base_len = ext - fp;
+	snprintf(dst, size, "%.*s_%02d%s", base_len, fp, p, ext);
+}
+
+// Decodes the 4bpp/8bpp indices once and expands them through every
+// palette of the CLUT to 32-bit BGRA, either one bitmap per palette or
+// all palettes stacked vertically in one strip (palette 0 on top).
+// Returns -1 if the image has no indexed palette.
+int tim2bmp_convert_palettes(char *ip, char *fp, tim2bmp_info *t, int strip)
+{
+	int colors, palettes, p, y, x;
+	int use_ssse3 = 0;
+	size_t data_size;
+	unsigned char *data, *idx;
+	unsigned int *pal, *row;
+	char name[1024];
+	FILE *i, *f = NULL;
+
+	if(!t->has_clut || t->compr || (t->bpp != 4 && t->bpp != 8))
+		return -1;
+
+	colors = (t->bpp == 4) ? 16 : 256;
+	palettes = t->clut_len / colors;
+
+	if(palettes == 0)
+		return -1;
+
+	data_size = (size_t)t->w * 2 * t->h;
+	data = malloc(data_size);
+	idx = malloc((size_t)t->real_w * t->h);
+	pal = malloc(colors * sizeof(unsigned int));
+	row = malloc((size_t)t->real_w * sizeof(unsigned int));
+
+	i = fopen(ip, "rb");
+	fseek(i, t->data_off, SEEK_SET);
+	memset(data, 0, data_size);
+	fread(data, 1, data_size, i);
+	fclose(i);
+
+	// One index byte per pixel; the low nibble is the left pixel.
+	if(t->bpp == 4)
+	{
+		for(x = 0; x < (int)data_size; x++)
+		{
+			idx[x * 2] = data[x] & 0xf;
+			idx[x * 2 + 1] = data[x] >> 4;
+		}
+	}
+	else
+		memcpy(idx, data, data_size);
+
+#ifdef TIM2BMP_SSSE3
+	use_ssse3 = (colors == 16) && __builtin_cpu_supports("ssse3");
+#endif
+
+	if(strip)
+	{
+		f = fopen(fp, "wb");
+		write_bitmap_headers(f, t->real_w, t->h * palettes, 32);
+	}
+
+	// Bitmaps are stored bottom-up, so the last palette is written first.
+	for(p = palettes - 1; p >= 0; p--)
+	{
+		for(x = 0; x < colors; x++)
+			pal[x] = rgbpsx_to_bgra32(t->clut[p * colors + x]);
+
+		if(!strip)
+		{
+			tim2bmp_palette_file_name(name, sizeof(name), fp, p);
+			f = fopen(name, "wb");
+			write_bitmap_headers(f, t->real_w, t->h, 32);
+		}
+
+		for(y = t->h - 1; y >= 0; y--)
+		{
+#ifdef TIM2BMP_SSSE3
+			if(use_ssse3)
+				tim2bmp_expand_row16_ssse3(idx + (size_t)y * t->real_w, pal, row, t->real_w);
+			else
+#endif
+				tim2bmp_expand_row(idx + (size_t)y * t->real_w, pal, row, t->real_w);
+
+			write_le_dwords(f, row, t->real_w);
+		}
+
+		if(!strip)
+		{
+			stats.bytes_written += ftell(f);
+			fclose(f);
+		}
+	}
+
+	if(strip)
+	{
+		stats.bytes_written += ftell(f);
+		fclose(f);
+	}
+
+	free(row);
+	free(pal);
+	free(idx);
+	free(data);
+
+	return palettes;
+}
+
+// Batch savestate VRAM diff. Each savestate's VRAM is inflated once,
+// compared with the previous state in 8x8 tiles (16-bit units) and
+// stored as a tile map into a content-addressed tile store, so a
+// capture set keeps every distinct tile only once.
+
+#define VRAM_W		1024
+#define VRAM_H		512
+#define VRAM_BYTES	(VRAM_W * VRAM_H * 2)
+#define TILE_UNITS	8
+#define TILE_ROW_BYTES	(TILE_UNITS * 2)
+#define TILE_BYTES	(TILE_ROW_BYTES * TILE_UNITS)
+#define TILES_X		(VRAM_W / TILE_UNITS)
+#define TILES_Y		(VRAM_H / TILE_UNITS)
+#define TILE_COUNT	(TILES_X * TILES_Y)
+
+typedef struct
+{
+	unsigned char *tiles; // TILE_BYTES per tile, in store order
+	unsigned int count;
+	unsigned int capacity;
+	unsigned int *slots; // hash table of tile id + 1, 0 = empty
+	unsigned int slot_mask;
+	FILE *f; // tiles.bin, new tiles are appended
+	int write_failed; // a new tile couldn't be appended to tiles.bin
+}tim2bmp_tile_store;
+
+// Inflates only the VRAM of a PCSX 1.5 savestate (1 MiB at data_off).
+int tim2bmp_inflate_vram(char *ip, unsigned char *vram)
+{
+	gzFile gzf = gzopen(ip, "rb");
+	int r;
+
+	if(gzf == NULL)
+		return -1;
+
+	if(gzseek(gzf, 0x2996C0, SEEK_SET) != 0x2996C0)
+	{
+		gzclose(gzf);
+		return -1;
+	}
+
+	r = gzread(gzf, vram, VRAM_BYTES);
+	gzclose(gzf);
+
+	return (r == VRAM_BYTES) ? 0 : -1;
+}
+
+// Copies tile (tx, ty) out of the VRAM into 128 contiguous bytes.
+void tim2bmp_get_tile(const unsigned char *vram, int tx, int ty, unsigned char *tile)
+{
+	int y;
+	const unsigned char *src = vram + ((size_t)ty * TILE_UNITS * VRAM_W + tx * TILE_UNITS) * 2;
+
+	for(y = 0; y < TILE_UNITS; y++)
+		memcpy(tile + y * TILE_ROW_BYTES, src + (size_t)y * VRAM_W * 2, TILE_ROW_BYTES);
+}
+
+int tim2bmp_tile_equal(const unsigned char *a, const unsigned char *b)
+{
+	int y;
+
+	for(y = 0; y < TILE_UNITS; y++)
+	{
+		if(memcmp(a + (size_t)y * VRAM_W * 2, b + (size_t)y * VRAM_W * 2, TILE_ROW_BYTES) != 0)
+			return 0;
+	}
+
+	return 1;
+}
+
+#ifdef TIM2BMP_SSSE3
+// A tile row is 16 bytes, so each row is one compare and the eight
+// row masks are and-ed together before a single movemask.
+__attribute__((target("sse2")))
+int tim2bmp_tile_equal_sse2(const unsigned char *a, const unsigned char *b)
+{
+	__m128i eq = _mm_set1_epi8(-1);
+	int y;
+
+	for(y = 0; y < TILE_UNITS; y++)
+	{
+		__m128i ra = _mm_loadu_si128((const __m128i*)(a + (size_t)y * VRAM_W * 2));
+		__m128i rb = _mm_loadu_si128((const __m128i*)(b + (size_t)y * VRAM_W * 2));
+		eq = _mm_and_si128(eq, _mm_cmpeq_epi8(ra, rb));
+	}
+
+	return _mm_movemask_epi8(eq) == 0xffff;
+}
+#endif
+
+// Marks every tile that differs between two VRAM snapshots.
+// Returns the number of changed tiles.
+int tim2bmp_diff_tiles(const unsigned char *prev, const unsigned char *cur, unsigned char *changed)
+{
+	int tx, ty, count = 0;
+	size_t off;
+	int use_sse2 = 0;
+
+#ifdef TIM2BMP_SSSE3
+	use_sse2 = __builtin_cpu_supports("sse2");
+#endif
+
+	for(ty = 0; ty < TILES_Y; ty++)
+	{
+		for(tx = 0; tx < TILES_X; tx++)
+		{
+			off = ((size_t)ty * TILE_UNITS * VRAM_W + tx * TILE_UNITS) * 2;
+#ifdef TIM2BMP_SSSE3
+			if(use_sse2)
+				changed[ty * TILES_X + tx] = !tim2bmp_tile_equal_sse2(prev + off, cur + off);
+			else
+#endif
+				changed[ty * TILES_X + tx] = !tim2bmp_tile_equal(prev + off, cur + off);
+
+			count += changed[ty * TILES_X + tx];
+		}
+	}
+
+	return count;
+}
+
+unsigned long long tim2bmp_tile_hash(const unsigned char *tile)
+{
+	unsigned long long h = 0x9E3779B97F4A7C15ULL;
+	unsigned long long w;
+	int x;
+
+	for(x = 0; x < TILE_BYTES; x += 8)
+	{
+		memcpy(&w, tile + x, 8);
+		h = (h ^ w) * 0xFF51AFD7ED558CCDULL;
+		h ^= h >> 32;
+	}
+
+	return h;
+}
+
+void tim2bmp_store_insert_slot(tim2bmp_tile_store *s, unsigned int id)
+{
+	unsigned int i = (unsigned int)tim2bmp_tile_hash(s->tiles + (size_t)id * TILE_BYTES) & s->slot_mask;
+
+	while(s->slots[i])
+		i = (i + 1) & s->slot_mask;
+
+	s->slots[i] = id + 1;
+}
+
+// Keeps the hash table at most half full.
+void tim2bmp_store_reserve(tim2bmp_tile_store *s, unsigned int count)
+{
+	unsigned int size = s->slot_mask + 1;
+	unsigned int id;
+
+	if(count > s->capacity)
+	{
+		while(s->capacity < count)
+			s->capacity = s->capacity ? s->capacity * 2 : 4096;
+
+		s->tiles = realloc(s->tiles, (size_t)s->capacity * TILE_BYTES);
+	}
+
+	if(s->slots != NULL && count * 2 <= size)
+		return;
+
+	while(count * 2 > size)
+		size *= 2;
+
+	free(s->slots);
+	s->slots = calloc(size, sizeof(unsigned int));
+	s->slot_mask = size - 1;
+
+	for(id = 0; id < s->count; id++)
+		tim2bmp_store_insert_slot(s, id);
+}
+
+// Returns the id of the tile, appending it to the store if it is new.
+unsigned int tim2bmp_store_add(tim2bmp_tile_store *s, const unsigned char *tile, int *added)
+{
+	unsigned int i = (unsigned int)tim2bmp_tile_hash(tile) & s->slot_mask;
+	unsigned int id;
+
+	while(s->slots[i])
+	{
+		id = s->slots[i] - 1;
+
+		if(memcmp(s->tiles + (size_t)id * TILE_BYTES, tile, TILE_BYTES) == 0)
+			return id;
+
+		i = (i + 1) & s->slot_mask;
+	}
+
+	tim2bmp_store_reserve(s, s->count + 1);
+	id = s->count++;
+	memcpy(s->tiles + (size_t)id * TILE_BYTES, tile, TILE_BYTES);
+	tim2bmp_store_insert_slot(s, id);
+	if(fwrite(tile, 1, TILE_BYTES, s->f) != TILE_BYTES)
+		s->write_failed = 1;
+	stats.bytes_written += TILE_BYTES;
+	*added += 1;
+
+	return id;
+}
+
+void tim2bmp_store_close(tim2bmp_tile_store *s)
+{
+	fclose(s->f);
+	free(s->slots);
+	free(s->tiles);
+}
+
+int tim2bmp_store_open(tim2bmp_tile_store *s, char *store, int create)
+{
+	char name[1024];
+	unsigned int id;
+	long size;
+
+	memset(s, 0, sizeof(tim2bmp_tile_store));
+	s->slot_mask = 4095;
+	if(create)
+		make_dir(store);
+
+	snprintf(name, sizeof(name), "%s/tiles.bin", store);
+
+	s->f = fopen(name, "a+b");
+
+	if(s->f == NULL)
+		return -1;
+
+	fseek(s->f, 0, SEEK_END);
+	size = ftell(s->f);
+	fseek(s->f, 0, SEEK_SET);
+
+	// A partial tile left by an interrupted write would shift the ids of
+	// every tile appended after it, so it is dropped.
+	if(size % TILE_BYTES)
+	{
+		printf("%s ends with a partial tile, %ld bytes dropped.\n", name, size % TILE_BYTES);
+		size -= size % TILE_BYTES;
+		if(truncate_file(s->f, size) != 0)
+		{
+			tim2bmp_store_close(s);
+			return -1;
+		}
+	}
+
+	tim2bmp_store_reserve(s, (unsigned int)(size / TILE_BYTES) + TILE_COUNT);
+	s->count = (unsigned int)(size / TILE_BYTES);
+
+	if(fread(s->tiles, TILE_BYTES, s->count, s->f) != s->count)
+	{
+		tim2bmp_store_close(s);
+		return -1;
+	}
+
+	stats.bytes_read += (size_t)s->count * TILE_BYTES;
+	tim2bmp_store_reserve(s, s->count + TILE_COUNT);
+
+	for(id = 0; id < s->count; id++)
+		tim2bmp_store_insert_slot(s, id);
+
+	fseek(s->f, 0, SEEK_END);
+	return 0;
+}
+
+// Name of the tile map of a savestate: <store>/<basename>.map
+void tim2bmp_map_file_name(char *dst, size_t size, char *store, char *ip)
+{
+	char *base = strrchr(ip, '/');
+	char *base2 = strrchr(ip, '\\');
+
+	if(base2 > base)
+		base = base2;
+
+	base = base ? base + 1 : ip;
+	snprintf(dst, size, "%s/%s.map", store, base);
+}
+
+// Prints the changed tiles as rectangles in VRAM units, one per group
+// of touching tiles (4-neighbourhood), and clears their flags.
+int tim2bmp_report_regions(unsigned char *changed)
+{
+	static int queue[TILE_COUNT];
+	int regions = 0, head, tail, t, tx, ty, x0, y0, x1, y1, tiles;
+	int n[4], k;
+
+	for(t = 0; t < TILE_COUNT; t++)
+	{
+		if(!changed[t])
+			continue;
+
+		head = 0;
+		tail = 0;
+		queue[tail++] = t;
+		changed[t] = 0;
+		x0 = x1 = t % TILES_X;
+		y0 = y1 = t / TILES_X;
+		tiles = 0;
+
+		while(head < tail)
+		{
+			tx = queue[head] % TILES_X;
+			ty = queue[head] / TILES_X;
+			head++;
+			tiles++;
+
+			if(tx < x0) x0 = tx;
+			if(tx > x1) x1 = tx;
+			if(ty < y0) y0 = ty;
+			if(ty > y1) y1 = ty;
+
+			n[0] = tx > 0 ? ty * TILES_X + tx - 1 : -1;
+			n[1] = tx < TILES_X - 1 ? ty * TILES_X + tx + 1 : -1;
+			n[2] = ty > 0 ? (ty - 1) * TILES_X + tx : -1;
+			n[3] = ty < TILES_Y - 1 ? (ty + 1) * TILES_X + tx : -1;
+
+			for(k = 0; k < 4; k++)
+			{
+				if(n[k] >= 0 && changed[n[k]])
+				{
+					changed[n[k]] = 0;
+					queue[tail++] = n[k];
+				}
+			}
+		}
+
+		printf("  region %d,%d %dx%d (%d tiles)\n", x0 * TILE_UNITS, y0 * TILE_UNITS,
+			(x1 - x0 + 1) * TILE_UNITS, (y1 - y0 + 1) * TILE_UNITS, tiles);
+		regions++;
+	}
+
+	return regions;
+}
+
+// tim2bmp -vramdiff <store> <state>...
+int tim2bmp_vram_diff(char *store, int count, char **states)
+{
+	tim2bmp_tile_store s;
+	unsigned char *vram[2], *changed, tile[TILE_BYTES];
+	unsigned int map[TILE_COUNT];
+	unsigned char map_bytes[TILE_COUNT * 4];
+	char name[1024];
+	int i, t, cur = 0, have_prev = 0, diff, added, failed = 0;
+	FILE *f;
+
+	if(tim2bmp_store_open(&s, store, 1) != 0)
+	{
+		printf("Couldn't open the tile store %s/tiles.bin.\n", store);
+		return -1;
+	}
+
+	vram[0] = malloc(VRAM_BYTES);
+	vram[1] = malloc(VRAM_BYTES);
+	changed = malloc(TILE_COUNT);
+
+	for(i = 0; i < count; i++)
+	{
+		stats_begin(PHASE_READ);
+		if(tim2bmp_inflate_vram(states[i], vram[cur]) != 0)
+		{
+			stats_end(PHASE_READ);
+			printf("%s: not a PCSX 1.5 savestate, skipped\n", states[i]);
+			failed++;
+			continue;
+		}
+		stats_end(PHASE_READ);
+		stats.bytes_read += stats_file_size(states[i]);
+
+		stats_begin(PHASE_PROCESS);
+		// The first state has nothing to compare with, so every tile is new.
+		if(have_prev)
+			diff = tim2bmp_diff_tiles(vram[cur ^ 1], vram[cur], changed);
+		else
+		{
+			memset(changed, 1, TILE_COUNT);
+			diff = TILE_COUNT;
+		}
+
+		// Unchanged tiles keep the id they had in the previous map.
+		added = 0;
+		for(t = 0; t < TILE_COUNT; t++)
+		{
+			if(!changed[t])
+				continue;
+
+			tim2bmp_get_tile(vram[cur], t % TILES_X, t / TILES_X, tile);
+			map[t] = tim2bmp_store_add(&s, tile, &added);
+		}
+		stats_end(PHASE_PROCESS);
+
+		// The map must not refer to tiles that aren't in tiles.bin.
+		if(s.write_failed || fflush(s.f) != 0)
+		{
+			printf("Couldn't write %s/tiles.bin, %s not saved.\n", store, states[i]);
+			failed++;
+			break;
+		}
+
+		stats_begin(PHASE_WRITE);
+		for(t = 0; t < TILE_COUNT; t++)
+		{
+			map_bytes[t * 4] = map[t] & 0xff;
+			map_bytes[t * 4 + 1] = (map[t] >> 8) & 0xff;
+			map_bytes[t * 4 + 2] = (map[t] >> 16) & 0xff;
+			map_bytes[t * 4 + 3] = map[t] >> 24;
+		}
+
+		tim2bmp_map_file_name(name, sizeof(name), store, states[i]);
+		f = fopen(name, "wb");
+		if(f == NULL)
+		{
+			printf("Couldn't write %s.\n", name);
+			failed++;
+		}
+		else
+		{
+			fwrite(map_bytes, 1, sizeof(map_bytes), f);
+			fclose(f);
+			stats.bytes_written += sizeof(map_bytes);
+		}
+		stats_end(PHASE_WRITE);
+
+		if(have_prev)
+		{
+			printf("%s: %d tiles changed, %d new in store\n", states[i], diff, added);
+			tim2bmp_report_regions(changed);
+		}
+		else
+			printf("%s: first state, %d tiles new in store\n", states[i], added);
+
+		have_prev = 1;
+		cur ^= 1;
+	}
+
+	printf("%u unique tiles in %s/tiles.bin\n", s.count, store);
+
+	free(changed);
+	free(vram[1]);
+	free(vram[0]);
+	tim2bmp_store_close(&s);
+
+	return failed ? -1 : 0;
+}
+
+// tim2bmp -vrammap <store> <map> <outbmp>: rebuilds a VRAM from its tile
+// map and writes it as a 24-bit bitmap, like a converted savestate.
+int tim2bmp_vram_from_map(char *store, char *mp, char *fp)
+{
+	tim2bmp_tile_store s;
+	unsigned char map_bytes[TILE_COUNT * 4];
+	unsigned char *vram, r, g, b;
+	unsigned int id;
+	unsigned short c;
+	int t, y, x;
+	FILE *f;
+
+	f = fopen(mp, "rb");
+	if(f == NULL || fread(map_bytes, 1, sizeof(map_bytes), f) != sizeof(map_bytes))
+	{
+		printf("Couldn't read the tile map %s.\n", mp);
+		if(f) fclose(f);
+		return -1;
+	}
+	fclose(f);
+
+	if(tim2bmp_store_open(&s, store, 0) != 0)
+	{
+		printf("Couldn't open the tile store %s/tiles.bin.\n", store);
+		return -1;
+	}
+
+	vram = malloc(VRAM_BYTES);
+
+	for(t = 0; t < TILE_COUNT; t++)
+	{
+		id = map_bytes[t * 4] | (map_bytes[t * 4 + 1] << 8) | (map_bytes[t * 4 + 2] << 16) | ((unsigned int)map_bytes[t * 4 + 3] << 24);
+
+		if(id >= s.count)
+		{
+			printf("Tile %u of %s is not in the store.\n", id, mp);
+			free(vram);
+			tim2bmp_store_close(&s);
+			return -1;
+		}
+
+		for(y = 0; y < TILE_UNITS; y++)
+		{
+			memcpy(vram + (((size_t)(t / TILES_X) * TILE_UNITS + y) * VRAM_W + (t % TILES_X) * TILE_UNITS) * 2,
+				s.tiles + (size_t)id * TILE_BYTES + y * TILE_ROW_BYTES, TILE_ROW_BYTES);
+		}
+	}
+
+	f = fopen(fp, "wb");
+	if(f == NULL)
+	{
+		printf("Couldn't open %s for writing.\n", fp);
+		free(vram);
+		tim2bmp_store_close(&s);
+		return -1;
+	}
+
+	write_bitmap_headers(f, VRAM_W, VRAM_H, 16);
+
+	for(y = VRAM_H - 1; y >= 0; y--)
+	{
+		for(x = 0; x < VRAM_W; x++)
+		{
+			c = vram[((size_t)y * VRAM_W + x) * 2] | (vram[((size_t)y * VRAM_W + x) * 2 + 1] << 8);
+			rgbpsx_to_rgb24(c, &r, &g, &b);
+			fputc(b, f);
+			fputc(g, f);
+			fputc(r, f);
+		}
+	}
+
+	stats.bytes_written += ftell(f);
+	fclose(f);
+	free(vram);
+	tim2bmp_store_close(&s);
+
+	return 0;
+}
+
 int main(int argc, char *argv[])
 {
 	//int x, y;
@@ -341,16 +1076,44 @@ int main(int argc, char *argv[])
 	int actual_w;
 	int bmp_bpp;*/
 	int r;
+	int palette_mode = 0; // 1 = one bitmap per palette, 2 = strip
 	tim2bmp_info *t = &tim_info;
 	
+	stats_parse_args(&argc, argv, "tim2bmp");
+	
+	if(argc > 3 && strcmp(argv[1], "-vramdiff") == 0)
+	{
+		stats.command = "vramdiff";
+		stats.input = argv[2];
+		r = tim2bmp_vram_diff(argv[2], argc - 3, argv + 3);
+		stats_report();
+		return r;
+	}
+
+	if(argc > 4 && strcmp(argv[1], "-vrammap") == 0)
+	{
+		stats.command = "vrammap";
+		stats.input = argv[3];
+		stats_begin(PHASE_PROCESS);
+		r = tim2bmp_vram_from_map(argv[2], argv[3], argv[4]);
+		stats_end(PHASE_PROCESS);
+		stats_report();
+		return r;
+	}
+	
 	if(argc < 2)
 	{
 		printf("tim2bmp - converts a TIM image to a bitmap\n");
 		printf("usage: tim2bmp <intim> <outbmp> [options]\n");
+		printf("       tim2bmp -vramdiff <store> <state> [<state>...]\n");
+		printf("       tim2bmp -vrammap <store> <map> <outbmp>\n");
 		printf("\n");
 		printf("Options:\n");
 		printf("  -o=<offset>\n");
 		printf("  -mpink - Convert transparency to magic pink\n");
+		printf("  -palettes - Write a 32bpp bitmap for every palette (out_00.bmp, ...)\n");
+		printf("  -strip - Write every palette into one 32bpp bitmap, stacked vertically\n");
+		printf("  --stats[=json] - Print timings and byte counts to stderr\n");
 		printf("\n");
 		return -1;
 	}
@@ -366,6 +1129,10 @@ int main(int argc, char *argv[])
 	{
 		if(strcmp(argv[x], "-mpink") == 0)
 			mpink_flag = 1;
+		else if(strcmp(argv[x], "-palettes") == 0)
+			palette_mode = 1;
+		else if(strcmp(argv[x], "-strip") == 0)
+			palette_mode = 2;
 	}
 
 	i = fopen(argv[1], "rb");
@@ -378,13 +1145,38 @@ int main(int argc, char *argv[])
 	
 	fclose(i);
 	
+	stats.command = "convert";
+	stats.input = argv[1];
+	stats_begin(PHASE_READ);
 	r = tim2bmp_read_tim(argv[1], &tim_info);
 	
 	if(r != 1)
 		r = tim2bmp_read_pcsx15(argv[1], &tim_info);
+	stats_end(PHASE_READ);
+	
+	// Pixels are read, converted and written row by row, so the
+	// whole conversion is timed as one phase.
+	stats.phase_names[PHASE_PROCESS] = "convert";
+	stats.bytes_read = stats_file_size(argv[1]);
 		
 	if(argc > 2)
-		tim2bmp_convert_image_data(argv[1], argv[2], t);
+	{
+		stats_begin(PHASE_PROCESS);
+		if(palette_mode)
+		{
+			r = tim2bmp_convert_palettes(argv[1], argv[2], t, palette_mode == 2);
+			
+			if(r < 0)
+				printf("The TIM has no 4bpp/8bpp palette to expand.\n");
+		}
+		else
+		{
+			tim2bmp_convert_image_data(argv[1], argv[2], t);
+			stats.bytes_written = stats_file_size(argv[2]);
+		}
+		stats_end(PHASE_PROCESS);
+	}
 
+	stats_report();
 	return 0;
 }
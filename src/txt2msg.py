@@ -5,12 +5,24 @@ txt2msg.py
 Description: Script to convert TXT to MSG.
 Author: happy_land
 Date: 24-06-17
-Last update: --
+Last update: 26-10-18
+
+Functionality:
+- Convert TXT to MSG.
+- With a cache file, re-encode only the blocks changed since the last run.
 """
 
 import re
 import os
 import sys
+import struct
+import hashlib
+import itertools
+
+import headertbl
+
+CACHE_MAGIC = b'D2BC'
+CACHE_DIGEST_SIZE = 16
 
 def load_moji_list(file_path):
     moji_list = {}
@@ -25,118 +37,175 @@ def load_moji_list(file_path):
                 print(f"Invalid value: '{value}' in line: '{line.strip()}'")
     return moji_list
     
-Moji_list = load_moji_list('Moji.tbl')
-
-def txt_to_bin(input_file):
-    global Moji_list
-    #  ̺ 
-    command_table = {
-        'func': b'',
-        'pos': b'\xfb\x06',
-        'wait': b'\xfb\x08',
-        'vwait': b'\xfb\x09',
-        'base_color': b'\xfb\x0a',
-        'init_color': b'\xfb\x0b',
-        'sel': b'\xfb\x0f',
-        'pagekey': b'\xfb\x18',
-        'voiceload': b'\xfb\x1a',
-        'item_name': b'\xfb\x20',
-        'button': b'\xfb\x22',
-        'endkey': b'\xfb\x24',
-        'space': b'\xfb\x2e',
-        'line': b'\xfc',
-        'nextpage': b'\xfd\x00',
-        'rubi': b'\xfe',
-        'endrubi': b'',
-        'end': b'\xff'
-    }
+Moji_list = load_moji_list(os.path.join(os.path.dirname(os.path.abspath(__file__)), 'Moji.tbl'))
+
+#  ̺ 
+COMMAND_TABLE = {
+    'func': b'',
+    'pos': b'\xfb\x06',
+    'wait': b'\xfb\x08',
+    'vwait': b'\xfb\x09',
+    'base_color': b'\xfb\x0a',
+    'init_color': b'\xfb\x0b',
+    'sel': b'\xfb\x0f',
+    'pagekey': b'\xfb\x18',
+    'voiceload': b'\xfb\x1a',
+    'item_name': b'\xfb\x20',
+    'button': b'\xfb\x22',
+    'endkey': b'\xfb\x24',
+    'space': b'\xfb\x2e',
+    'line': b'\xfc',
+    'nextpage': b'\xfd\x00',
+    'rubi': b'\xfe',
+    'endrubi': b'',
+    'end': b'\xff'
+}
+
+#  ϳ (--  ؽƮ) ȯ
+def encode_block(block):
+    binary_data = b''
+    lines = block.split('\n')
+
+    for line in lines:
+        if '//' in line:
+            line = line.split('//')[0]
+
+        tokens = re.split(r'(' + '|'.join(COMMAND_TABLE.keys()) + r'|_([0-9a-fA-F]{4})(\((.*?)\))?)', line)
+
+        for token in tokens:
+            if token is None:
+                continue
+
+            # ɾ ó
+            if token in COMMAND_TABLE:
+                binary_data += COMMAND_TABLE[token]
+                match = re.search(rf'{token}\((.*?)\)', line)
+                if match:
+                    values = match.group(1).split(',')
+                    for value in values:
+                        if value.startswith('%H'):
+                            binary_data += int(value[2:]).to_bytes(2, 'big')
+                        elif value.startswith('%I'):
+                            binary_data += int(value[2:]).to_bytes(4, 'big')
+                        else:
+                            binary_data += int(value).to_bytes(1, 'big')
+                line = re.sub(rf'{token}\(.*?\)', '', line)
+                line = line.replace(token, '')
+
+            # 16 ɾ ó
+            elif token.startswith('_'):
+                match = re.search(r'_([0-9a-fA-F]{4})(\((.*?)\))?', token)
+                if match:
+                    binary = bytes([int(match.group(1)[0:2], 16)]) + bytes([int(match.group(1)[2:4], 16)])
+                    binary_data += binary
+                    if match.group(3):
+                        values = match.group(3).split(',')
+                        for value in values:
+                            if value.startswith('%H'):
+                                binary_data += int(value[2:]).to_bytes(2, 'big')
+                            elif value.startswith('%I'):
+                                binary_data += int(value[2:]).to_bytes(4, 'big')
+                            else:
+                                binary_data += int(value).to_bytes(1, 'big')
+
+            #  ó
+            else:
+                for char in token:
+                    if char in Moji_list:
+                        binary_data += Moji_list[char]
 
+    return binary_data
+
+#  ĳ:  ؽƮ ؽ -> ȯ 
+#  ̺ ٲ ĳ ü 
+def moji_digest():
+    digest = hashlib.blake2b(digest_size=CACHE_DIGEST_SIZE)
+    for char, code in sorted(Moji_list.items()):
+        digest.update(char.encode('utf-8') + b'=' + code + b'\n')
+    return digest.digest()
+
+def block_digest(block):
+    return hashlib.blake2b(block.encode('utf-8'), digest_size=CACHE_DIGEST_SIZE).digest()
+
+def load_block_cache(cache_file):
+    cache = {}
+    if not cache_file or not os.path.exists(cache_file):
+        return cache
+
+    with open(cache_file, 'rb') as f:
+        data = f.read()
+    if data[:4] != CACHE_MAGIC or data[4:4 + CACHE_DIGEST_SIZE] != moji_digest():
+        return cache
+
+    offset = 4 + CACHE_DIGEST_SIZE
+    while offset < len(data):
+        key = data[offset:offset + CACHE_DIGEST_SIZE]
+        size = struct.unpack_from('<I', data, offset + CACHE_DIGEST_SIZE)[0]
+        offset += CACHE_DIGEST_SIZE + 4
+        cache[key] = data[offset:offset + size]
+        offset += size
+    return cache
+
+# ̹ ȯ  ϸ  (ĳð  Ŀ ʵ)
+def save_block_cache(cache_file, cache):
+    temp_file = cache_file + '.tmp'
+    with open(temp_file, 'wb') as f:
+        f.write(CACHE_MAGIC + moji_digest())
+        for key, data in cache.items():
+            f.write(key + struct.pack('<I', len(data)) + data)
+    os.replace(temp_file, cache_file)
+
+# cache:   ޸𸮿 ϴ  ĳ (watch.pyó  Ǵ )
+def txt_to_bin(input_file, cache_file=None, cache=None):
     with open(input_file, 'r', encoding='utf-8') as f:
         script = f.read()
 
     # Ϻ 
     blocks = script.split('--')
-    # ȯ 
-    binary_data = b''
-    # ʵ ()
-    posfiled = b''
-    posfiled_length = len(blocks) << 1
+    old_cache = load_block_cache(cache_file) if cache is None else cache
+    new_cache = {}
+    encoded_blocks = []
 
-    #  Ͽ  ó
+    # ٲ ϸ ٽ ȯ
     for block in blocks:
-        lines = block.split('\n')
-
-        # ʵ忡    ߰ (ʵ ̸ )
-        posfiled += (len(binary_data) + posfiled_length).to_bytes(2, 'little')
-
-        for line in lines:
-            if '//' in line:
-                line = line.split('//')[0]
-
-            tokens = re.split(r'(' + '|'.join(command_table.keys()) + r'|_([0-9a-fA-F]{4})(\((.*?)\))?)', line)
+        key = block_digest(block)
+        data = new_cache.get(key)
+        if data is None:
+            data = old_cache.get(key)
+            if data is None:
+                data = encode_block(block)
+            new_cache[key] = data
+        encoded_blocks.append(data)
+
+    # ʵ ():  ũ   (ʵ ̸ )
+    posfiled_length = len(blocks) << 1
+    offsets = itertools.accumulate((len(data) for data in encoded_blocks[:-1]), initial=posfiled_length)
+    posfiled = b''.join(offset.to_bytes(2, 'little') for offset in offsets)
 
-            for token in tokens:
-                if token is None:
-                    continue
+    if cache is not None:
+        cache.clear()
+        cache.update(new_cache)
+    elif cache_file:
+        save_block_cache(cache_file, new_cache)
 
-                # ɾ ó
-                if token in command_table:
-                    binary_data += command_table[token]
-                    match = re.search(rf'{token}\((.*?)\)', line)
-                    if match:
-                        values = match.group(1).split(',')
-                        for value in values:
-                            if value.startswith('%H'):
-                                binary_data += int(value[2:]).to_bytes(2, 'big')
-                            elif value.startswith('%I'):
-                                binary_data += int(value[2:]).to_bytes(4, 'big')
-                            else:
-                                binary_data += int(value).to_bytes(1, 'big')
-                    line = re.sub(rf'{token}\(.*?\)', '', line)
-                    line = line.replace(token, '')
-
-                # 16 ɾ ó
-                elif token.startswith('_'):
-                    match = re.search(r'_([0-9a-fA-F]{4})(\((.*?)\))?', token)
-                    if match:
-                        binary = bytes([int(match.group(1)[0:2], 16)]) + bytes([int(match.group(1)[2:4], 16)])
-                        binary_data += binary
-                        if match.group(3):
-                            values = match.group(3).split(',')
-                            for value in values:
-                                if value.startswith('%H'):
-                                    binary_data += int(value[2:]).to_bytes(2, 'big')
-                                elif value.startswith('%I'):
-                                    binary_data += int(value[2:]).to_bytes(4, 'big')
-                                else:
-                                    binary_data += int(value).to_bytes(1, 'big')
-
-                #  ó
-                else:
-                    for char in token:
-                        if char in Moji_list:
-                            binary_data += Moji_list[char]
-
-    binary_data = posfiled + binary_data
-    
-    return binary_data
+    return posfiled + b''.join(encoded_blocks)
 
 def calculate_padded_size(size, block_size):
     return (size + block_size - 1) & ~(block_size - 1)
     
 def write_header_to_header_bin(header, directory, offset):
     header_bin_path = os.path.join(directory, "HEADER.BIN")
-    with open(header_bin_path, 'r+b') as f:
-        f.seek(offset)
-        f.write(header)
+    with headertbl.HeaderTable(header_bin_path) as table:
+        table.set(offset // headertbl.HEADER_SIZE, header)
 
 def main():
     if len(sys.argv) < 2:
-        print("Usage: python txt2msg.py <input_file> [<is_header>]")
+        print("Usage: python txt2msg.py <input_file> [<is_header>] [<cache_file>]")
         sys.exit(1)
     
     input_file = sys.argv[1]
     is_header = sys.argv[2] if len(sys.argv) > 2 else None
+    cache_file = sys.argv[3] if len(sys.argv) > 3 else None
 
     file_name_prefix = os.path.basename(input_file)[:4]
 
@@ -147,7 +216,7 @@ def main():
     base_name = os.path.splitext(input_file)[0]
     output_file = base_name + ".MSG"
 
-    binary_data = txt_to_bin(input_file)
+    binary_data = txt_to_bin(input_file, cache_file)
 
     if is_header and int(is_header) == 1:
         sign_bytes = (0x12).to_bytes(4, 'little')
@@ -170,8 +239,11 @@ def main():
         input_file_directory = os.path.dirname(input_file)
         write_header_to_header_bin(header, input_file_directory, offset)
 
-    with open(output_file, 'wb') as f:
+    # combbin -X ϵ帵ũ MSG  Ƿ ӽ Ͽ   ü
+    temp_file = f"{output_file}.tmp"
+    with open(temp_file, 'wb') as f:
         f.write(binary_data)
+    os.replace(temp_file, output_file)
 
 if __name__ == "__main__":
     main()
\ No newline at end of file
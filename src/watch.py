@@ -0,0 +1,258 @@
+# -*- coding: cp949 -*-
+"""
+watch.py
+
+Description: Daemon that watches an extracted project tree and patches the BIN archives when a source file changes.
+Author: happy_land
+Date: 26-10-18
+Last update: --
+
+Functionality:
+- Watch the TXT, TIM and PIX files of folders extracted with combbin.py
+  (inotify on Linux, polling elsewhere).
+- Re-encode a TXT to MSG, recompress a PIX to MTIM and replace only the changed entry of the BIN archive.
+- Keep the character table, every HEADER.BIN and the encoded script blocks in memory between updates.
+"""
+
+import os
+import sys
+import time
+import select
+import struct
+import ctypes
+import ctypes.util
+import subprocess
+
+import combbin
+import headertbl
+import txt2msg
+
+HEADER_SIZE = 0x30
+CHUNK_SIZE = 0x800
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+EXE_SUFFIX = '.exe' if os.name == 'nt' else ''
+
+SOURCE_EXTENSIONS = ('.TXT', '.TIM', '.PIX')
+SETTLE_TIME = 0.2  # Ⱑ       ٸ ð ()
+
+# inotify ̺Ʈ (<sys/inotify.h>)
+IN_CLOSE_WRITE = 0x00000008
+IN_MOVED_TO = 0x00000080
+IN_CREATE = 0x00000100
+IN_ISDIR = 0x40000000
+IN_CLOEXEC = 0o2000000
+INOTIFY_EVENT = struct.Struct('iIII')
+
+def tool_path(name):
+    return os.path.join(SCRIPT_DIR, name + EXE_SUFFIX)
+
+def is_source_file(path):
+    name = os.path.basename(path)
+    return name[:4].isdigit() and os.path.splitext(name)[1].upper() in SOURCE_EXTENSIONS
+
+class InotifyWatcher:
+    """inotify  Ʈ  (      ߰)"""
+
+    def __init__(self, root):
+        self.libc = ctypes.CDLL(ctypes.util.find_library('c') or None, use_errno=True)
+        self.fd = self.libc.inotify_init1(IN_CLOEXEC)
+        if self.fd < 0:
+            raise OSError(ctypes.get_errno(), "inotify_init1 failed")
+        self.folders = {}
+        for folder, _, _ in os.walk(root):
+            self.add_watch(folder)
+
+    def add_watch(self, folder):
+        mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE
+        wd = self.libc.inotify_add_watch(self.fd, os.fsencode(folder), mask)
+        if wd < 0:
+            raise OSError(ctypes.get_errno(), f"inotify_add_watch failed: {folder}")
+        self.folders[wd] = folder
+
+    def wait(self, timeout=None):
+        """ٲ    ȯ (timeout  ̺Ʈ   )"""
+        changed = set()
+        while True:
+            ready, _, _ = select.select([self.fd], [], [], timeout)
+            if not ready:
+                return changed
+
+            data = os.read(self.fd, 0x10000)
+            offset = 0
+            while offset < len(data):
+                wd, mask, _, name_length = INOTIFY_EVENT.unpack_from(data, offset)
+                offset += INOTIFY_EVENT.size
+                name = os.fsdecode(data[offset:offset + name_length].rstrip(b'\0'))
+                offset += name_length
+
+                folder = self.folders.get(wd)
+                if folder is None or not name:
+                    continue
+                path = os.path.join(folder, name)
+                if mask & IN_ISDIR:
+                    if mask & IN_CREATE:
+                        self.add_watch(path)
+                elif mask & (IN_CLOSE_WRITE | IN_MOVED_TO):
+                    changed.add(path)
+
+            # ù ̺Ʈ ڷδ   Ƽ   ó
+            timeout = SETTLE_TIME
+
+    def close(self):
+        os.close(self.fd)
+
+class PollingWatcher:
+    """inotify  ȯ:  ð ũ⸦ ֱ """
+
+    def __init__(self, root, interval=0.5):
+        self.root = root
+        self.interval = interval
+        self.snapshot = self.scan()
+
+    def scan(self):
+        snapshot = {}
+        for folder, _, files in os.walk(self.root):
+            for name in files:
+                path = os.path.join(folder, name)
+                if is_source_file(path):
+                    try:
+                        st = os.stat(path)
+                    except OSError:
+                        continue
+                    snapshot[path] = (st.st_mtime_ns, st.st_size)
+        return snapshot
+
+    def wait(self, timeout=None):
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            time.sleep(self.interval)
+            snapshot = self.scan()
+            changed = {path for path, state in snapshot.items() if self.snapshot.get(path) != state}
+            self.snapshot = snapshot
+            if changed or (deadline is not None and time.monotonic() >= deadline):
+                return changed
+
+    def close(self):
+        pass
+
+def create_watcher(root, polling=False):
+    if not polling and sys.platform.startswith('linux'):
+        try:
+            return InotifyWatcher(root)
+        except (OSError, AttributeError) as e:
+            print(f"inotify is not available ({e}), falling back to polling")
+    return PollingWatcher(root)
+
+class Project:
+    """  Ʈ BIN ī̺  , ޸𸮿 ϴ """
+
+    def __init__(self, project_folder, archive_folder):
+        self.project_folder = os.path.abspath(project_folder)
+        self.archive_folder = os.path.abspath(archive_folder)
+        self.headers = {}       #  -> (HEADER.BIN  ð, )
+        self.block_caches = {}  # TXT  -> txt2msg  ĳ
+
+        for folder, _, files in os.walk(self.project_folder):
+            if 'HEADER.BIN' in files:
+                self.header_data(folder)
+
+    def header_data(self, folder):
+        """HEADER.BIN  (MELTTIMTool   쿡 ٽ )"""
+        header_filename = os.path.join(folder, 'HEADER.BIN')
+        mtime = os.stat(header_filename).st_mtime_ns
+        cached = self.headers.get(folder)
+        if cached is None or cached[0] != mtime:
+            with open(header_filename, 'rb') as f:
+                cached = (mtime, bytearray(f.read()))
+            self.headers[folder] = cached
+        return cached[1]
+
+    def write_header(self, folder, index, header):
+        """׸  ϳ HEADER.BIN ݿϰ ޸ 뵵  ħ"""
+        header_filename = os.path.join(folder, 'HEADER.BIN')
+        table = headertbl.HeaderTable(header_filename)
+        table.set(index, header)
+        data = table.commit()
+        self.headers[folder] = (os.stat(header_filename).st_mtime_ns, data)
+
+    def encode_txt(self, txt_file, folder, index):
+        """TXT -> MSG (ٲ ϸ ٽ ȯ), HEADER.BIN ũ⵵ """
+        cache = self.block_caches.setdefault(txt_file, {})
+        binary_data = txt2msg.txt_to_bin(txt_file, cache=cache)
+
+        msg_file = os.path.splitext(txt_file)[0] + '.MSG'
+        combbin.replace_file(msg_file, binary_data)  # -X ϵ帵ũ MSG  ϸ ٲ
+
+        header = bytearray(self.header_data(folder)[index * HEADER_SIZE:(index + 1) * HEADER_SIZE])
+        padded_size = combbin.pad_to_multiple_of(HEADER_SIZE + len(binary_data), CHUNK_SIZE)
+        struct.pack_into('<II', header, 0x04, len(binary_data), padded_size // CHUNK_SIZE)
+        self.write_header(folder, index, header)
+        return msg_file
+
+    def compress_pix(self, pix_file):
+        """   PIX -> MTIM (ٲ 츸 ٽ , MELTTIMTool HEADER.BIN )"""
+        mtim_file = os.path.splitext(pix_file)[0] + '.MTIM'
+        subprocess.run([tool_path('MELTTIMTool'), 'p', pix_file, mtim_file], check=True, stdout=subprocess.DEVNULL)
+        return mtim_file
+
+    def handle(self, path):
+        """ٲ ҽ  ϳ ī̺꿡 ݿ. ó ʴ ̸ False"""
+        folder = os.path.dirname(os.path.abspath(path))
+        name = os.path.basename(path)
+        extension = os.path.splitext(name)[1].upper()
+        archive_file = os.path.join(self.archive_folder, os.path.basename(folder) + '.BIN')
+
+        if not is_source_file(path) or not os.path.exists(path):
+            return False
+        if not os.path.exists(os.path.join(folder, 'HEADER.BIN')):
+            return False
+        if not os.path.exists(archive_file):
+            print(f"Skipping {name}: {archive_file} does not exist")
+            return False
+
+        index = int(name[:4])
+        header = self.header_data(folder)[index * HEADER_SIZE:(index + 1) * HEADER_SIZE]
+        if len(header) < HEADER_SIZE:
+            print(f"Skipping {name}: entry {index} is not in HEADER.BIN")
+            return False
+        kind = struct.unpack_from('<I', header, 0)[0]
+
+        if extension == '.TXT':
+            entry_file = self.encode_txt(path, folder, index)
+        elif extension == '.PIX' and kind == 0x03:  # MTIM   PIX
+            entry_file = self.compress_pix(path)
+        else:  # TIM, PIX ׸ ״ ü
+            entry_file = path
+
+        combbin.update_entry(archive_file, index, entry_file)
+        return True
+
+def watch(project_folder, archive_folder, polling=False):
+    project = Project(project_folder, archive_folder)
+    watcher = create_watcher(project.project_folder, polling)
+    print(f"Watching {project.project_folder} ({len(project.headers)} folders, {type(watcher).__name__})")
+
+    try:
+        while True:
+            changed = watcher.wait()
+            for path in sorted(changed):
+                start = time.perf_counter()
+                try:
+                    if project.handle(path):
+                        print(f"{os.path.relpath(path, project.project_folder)}: {(time.perf_counter() - start) * 1000:.1f} ms")
+                except Exception as e:
+                    # ߸ TXT ϳ  ð  ʵ  
+                    print(f"Error: {path}: {e}")
+    except KeyboardInterrupt:
+        pass
+    finally:
+        watcher.close()
+
+if __name__ == '__main__':
+    args = [arg for arg in sys.argv[1:] if arg != '--poll']
+    if len(args) != 2:
+        print("Usage: python watch.py <project_folder> <archive_folder> [--poll]")
+        sys.exit(1)
+
+    watch(args[0], args[1], '--poll' in sys.argv[1:])